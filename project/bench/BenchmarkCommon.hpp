@@ -0,0 +1,81 @@
+#ifndef FINITEDIFFERENCEMETHOD_BENCHMARKCOMMON_HPP_
+#define FINITEDIFFERENCEMETHOD_BENCHMARKCOMMON_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "Model.hpp"
+#include "SolutionStorage.hpp"
+
+/*
+ * Pieces, that every model benchmark needs: the final layer copy, timed
+ * integration and the tube problem of solution.cpp.
+ */
+namespace bench {
+using NodeType = fdm::Model::ModelNodeType;
+
+// Plate of solution.cpp
+constexpr double Width = 6.0;
+constexpr double Height = 4.0;
+
+// Keeps the last committed layer row by row
+class LayerCopyStorage : public fdm::solution::SolutionStorageBase<NodeType> {
+ public:
+  void CommitLayer(const MeshPointerType &mesh_ptr) override {
+    cols = mesh_ptr->SizeCols();
+    layer.resize(mesh_ptr->SizeRows() * cols);
+    for (size_t i = 0; i < mesh_ptr->SizeRows(); ++i) {
+      mesh_ptr->CopyRow(i, layer.data() + i * cols);
+    }
+  }
+
+  size_t cols = 0;
+  std::vector<NodeType> layer;
+};
+
+struct RunResult {
+  LayerCopyStorage result;
+  double seconds;
+};
+
+// Only the integration is timed, the final layer is saved after it
+template <typename ModelType>
+RunResult Integrate(ModelType &model, double total_time) {
+  fdm::solution::PlaceholderStorage<NodeType> placeholder;
+  RunResult run;
+  auto start = std::chrono::steady_clock::now();
+  model.TimeIntegrate(total_time, placeholder, 0);
+  auto finish = std::chrono::steady_clock::now();
+  run.seconds = std::chrono::duration<double>(finish - start).count();
+  model.SaveResult(run.result);
+  return run;
+}
+
+// Hole of the tube, the same for Model and ModelFixed
+template <typename ModelType>
+void SetTubeHole(ModelType &model) {
+  model.SetHoleGeometry(fdm::Model::Point(2.0, 1.0),
+                        fdm::Model::Point(5.0, 1.0),
+                        fdm::Model::Point(5.0, 3.0));
+}
+
+// Outer and inner restrictions of the tube
+inline void SetTubeRestrictions(fdm::Model &model) {
+  fdm::restr::BoundaryRestrictionsStorageType<NodeType> restrictions;
+  restrictions[fdm::restr::UP_RESTRICTION] =
+      std::make_shared<fdm::restr::FirstKindRestriction<NodeType>>(20.0);
+  restrictions[fdm::restr::DOWN_RESTRICTION] =
+      std::make_shared<fdm::restr::SecondKindRestriction<NodeType>>(40.0);
+  restrictions[fdm::restr::LEFT_RESTRICTION] =
+      std::make_shared<fdm::restr::SecondKindRestriction<NodeType>>(40.0);
+  restrictions[fdm::restr::RIGHT_RESTRICTION] =
+      std::make_shared<fdm::restr::SecondKindRestriction<NodeType>>(40.0);
+  model.SetOuterRestrictions(restrictions);
+  model.SetInnerRestrictions(
+      std::make_shared<fdm::restr::ThirdKindRestriction<NodeType>>());
+}
+}  // namespace bench
+
+#endif  // FINITEDIFFERENCEMETHOD_BENCHMARKCOMMON_HPP_
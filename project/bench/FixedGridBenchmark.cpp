@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "BenchmarkCommon.hpp"
+#include "Model.hpp"
+#include "ModelFixed.hpp"
+
+/*
+ * Runtime sized Model against ModelFixed on the same problems: the
+ * production mesh of solution.cpp and two finer meshes of the same
+ * plate. Both models have to give identical layers, so the difference
+ * is printed along with the time.
+ */
+
+namespace {
+using bench::Height;
+using bench::Integrate;
+using bench::RunResult;
+using bench::Width;
+
+constexpr fdm::fixed::Restrictions Restrictions{
+    fdm::fixed::FirstKind(20.0), fdm::fixed::SecondKind(40.0),
+    fdm::fixed::SecondKind(40.0), fdm::fixed::SecondKind(40.0),
+    fdm::fixed::ThirdKind()};
+
+template <typename ModelType>
+void SetTube(ModelType &model) {
+  model.SetInitialCondition(20);
+  bench::SetTubeHole(model);
+}
+
+RunResult RunDynamic(const fdm::fixed::Grid &grid, double total_time) {
+  fdm::Model model(Width, Height, grid.delta, grid.time_delta);
+  model.SetDiffusivity(grid.diffusivity);
+  SetTube(model);
+  bench::SetTubeRestrictions(model);
+  return Integrate(model, total_time);
+}
+
+template <fdm::fixed::Grid Grid>
+void Compare(double total_time) {
+  RunResult dynamic = RunDynamic(Grid, total_time);
+
+  auto model = std::make_unique<fdm::ModelFixed<Grid, Restrictions>>();
+  SetTube(*model);
+  RunResult fixed = Integrate(*model, total_time);
+
+  double difference = 0.0;
+  for (size_t i = 0; i < dynamic.result.layer.size(); ++i) {
+    difference = std::max(difference, std::abs(dynamic.result.layer[i] -
+                                                fixed.result.layer[i]));
+  }
+  std::cout << std::setw(12)
+            << std::to_string(Grid.rows) + "x" + std::to_string(Grid.cols)
+            << std::setw(10)
+            << static_cast<size_t>(total_time / Grid.time_delta)
+            << std::setw(14) << dynamic.seconds << std::setw(14)
+            << fixed.seconds << std::setw(10)
+            << dynamic.seconds / fixed.seconds << std::setw(14) << difference
+            << std::endl;
+}
+}  // anonymous namespace
+
+int main() {
+  std::cout << std::setw(12) << "mesh" << std::setw(10) << "steps"
+            << std::setw(14) << "dynamic, s" << std::setw(14) << "fixed, s"
+            << std::setw(10) << "speedup" << std::setw(14) << "difference"
+            << std::endl;
+  // Production mesh of solution.cpp
+  Compare<fdm::fixed::MakeGrid(Width, Height, 0.45, 0.1)>(25000.0);
+  Compare<fdm::fixed::MakeGrid(Width, Height, 0.05, 0.005)>(100.0);
+  Compare<fdm::fixed::MakeGrid(Width, Height, 0.02, 0.001)>(5.0);
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "MatrixTiled.hpp"
+
+/*
+ * Compares row-major and tiled mesh layouts on the explicit 5-point
+ * stencil sweep, that traverses the mesh tile by tile, the same way
+ * as Model::ComputePlate does.
+ */
+
+namespace {
+constexpr size_t NodeUpdatesPerRun = 200'000'000;
+
+inline double Update(double center, double left, double right, double up,
+                     double down) {
+  return center + 0.1 * (left + right + up + down - 4 * center);
+}
+
+template <typename MatrixClass>
+double MeasureSweeps(size_t rows, size_t cols, double &checksum) {
+  auto last = std::make_unique<MatrixClass>(rows, cols);
+  auto present = std::make_unique<MatrixClass>(rows, cols);
+  last->FillMatrix(20.0);
+  present->FillMatrix(20.0);
+  last->At(rows / 2, cols / 2) = 100.0;
+
+  size_t sweeps = std::max<size_t>(NodeUpdatesPerRun / (rows * cols), 1);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t s = 0; s < sweeps; ++s) {
+    for (const mtrx::Tile &tile : last->Tiles()) {
+      size_t row_begin = std::max<size_t>(tile.row_begin, 1);
+      size_t row_end = std::min(tile.row_end, rows - 1);
+      size_t col_begin = std::max<size_t>(tile.col_begin, 1);
+      size_t col_end = std::min(tile.col_end, cols - 1);
+      for (size_t j = row_begin; j < row_end; ++j) {
+        // Row segment of the tile is contiguous for every layout, so
+        // only the segment ends need the accessor.
+        const double *up = &last->At(j - 1, col_begin);
+        const double *center = &last->At(j, col_begin);
+        const double *down = &last->At(j + 1, col_begin);
+        double *result = &present->At(j, col_begin);
+        size_t last_k = col_end - col_begin - 1;
+        double left_edge = last->At(j, col_begin - 1);
+        double right_edge = last->At(j, col_end);
+        if (last_k == 0) {
+          result[0] = Update(center[0], left_edge, right_edge, up[0], down[0]);
+          continue;
+        }
+        result[0] = Update(center[0], left_edge, center[1], up[0], down[0]);
+        for (size_t k = 1; k < last_k; ++k) {
+          result[k] =
+              Update(center[k], center[k - 1], center[k + 1], up[k], down[k]);
+        }
+        result[last_k] = Update(center[last_k], center[last_k - 1],
+                                right_edge, up[last_k], down[last_k]);
+      }
+    }
+    std::swap(last, present);
+  }
+  auto finish = std::chrono::steady_clock::now();
+
+  checksum += last->At(rows / 2, cols / 2);
+  double total_ns =
+      std::chrono::duration<double, std::nano>(finish - start).count();
+  return total_ns / static_cast<double>(sweeps * rows * cols);
+}
+}  // anonymous namespace
+
+int main() {
+  using RowMajor = mtrx::MatrixDynamic<double>;
+  using Tiled = mtrx::MatrixTiled<double, 32, mtrx::TileOrder::RowMajor>;
+  using Morton = mtrx::MatrixTiled<double, 32, mtrx::TileOrder::Morton>;
+
+  const std::vector<std::pair<size_t, size_t>> sizes{
+      {256, 256}, {1024, 1024}, {2048, 2048}, {4096, 4096}, {512, 16384}};
+
+  double checksum = 0.0;
+  std::cout << "ns per node update" << std::endl;
+  std::cout << std::setw(14) << "grid" << std::setw(12) << "row-major"
+            << std::setw(12) << "tiled" << std::setw(12) << "morton"
+            << std::endl;
+  for (auto [rows, cols] : sizes) {
+    double row_major = MeasureSweeps<RowMajor>(rows, cols, checksum);
+    double tiled = MeasureSweeps<Tiled>(rows, cols, checksum);
+    double morton = MeasureSweeps<Morton>(rows, cols, checksum);
+    std::cout << std::setw(8) << rows << 'x' << std::setw(5) << std::left
+              << cols << std::right << std::setw(12) << row_major
+              << std::setw(12) << tiled << std::setw(12) << morton
+              << std::endl;
+  }
+  std::cout << "checksum: " << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numbers>
+
+#include "BenchmarkCommon.hpp"
+#include "Model.hpp"
+
+/*
+ * Error against runtime for the second and fourth order spatial
+ * stencils on two problems.
+ *
+ * Smooth plate: no hole, zero first kind restrictions and a single sine
+ * mode as the initial condition. Exact solution is known, so it is the
+ * reference for both orders, and the error is the interior stencil error.
+ * Time step is small enough to keep the time discretization error below
+ * the spatial one.
+ *
+ * Tube: the problem of solution.cpp. Its error is dominated by the first
+ * order hole and outer restrictions, so the fourth order doesn't help
+ * there. Each order is compared with its own solution on the finest mesh,
+ * in the nodes, that coarse and fine meshes share.
+ */
+
+namespace {
+using bench::Height;
+using bench::Integrate;
+using bench::NodeType;
+using bench::RunResult;
+using bench::Width;
+using Order = fdm::Model::SpatialOrder;
+
+constexpr double Diffusivity = 0.1;
+
+// Smooth plate: mode sin(3 pi x / Lx) sin(2 pi y / Ly)
+constexpr double SmoothTimeDelta = 1e-4;
+constexpr double SmoothTotalTime = 1.0;
+constexpr double Amplitude = 20.0;
+constexpr double ModeX = 3.0;
+constexpr double ModeY = 2.0;
+
+// Tube: mesh steps are powers of two, so coarse nodes are fine nodes
+constexpr double TubeTimeDelta = 4e-4;
+constexpr double TubeTotalTime = 1.0;
+constexpr double ReferenceDelta = 1.0 / 64;
+
+struct Error {
+  double max = 0.0;
+  double square_sum = 0.0;
+  size_t nodes = 0;
+
+  void Add(double error) {
+    max = std::max(max, std::abs(error));
+    square_sum += error * error;
+    ++nodes;
+  }
+  [[nodiscard]] double Rms() const {
+    return std::sqrt(square_sum / static_cast<double>(nodes));
+  }
+};
+
+// Nodes i * delta, i < size / delta, the last one is on the restriction
+double Span(double size, double delta) {
+  return static_cast<double>(static_cast<size_t>(size / delta) - 1) * delta;
+}
+
+double SmoothSolution(double x, double y, double time, double delta) {
+  double kx = ModeX * std::numbers::pi / Span(Width, delta);
+  double ky = ModeY * std::numbers::pi / Span(Height, delta);
+  return Amplitude * std::exp(-Diffusivity * (kx * kx + ky * ky) * time) *
+         std::sin(kx * x) * std::sin(ky * y);
+}
+
+RunResult RunSmooth(double delta, Order order) {
+  fdm::Model model(Width, Height, delta, SmoothTimeDelta);
+  model.SetDiffusivity(Diffusivity);
+  model.SetSpatialOrder(order);
+  model.SetInitialCondition([delta](fdm::Model::Point point) {
+    return SmoothSolution(point.x, point.y, 0.0, delta);
+  });
+
+  auto zero = std::make_shared<fdm::restr::FirstKindRestriction<NodeType>>();
+  model.SetOuterRestrictions(zero, zero, zero, zero);
+  model.SetInnerRestrictions(zero);
+  // Hole is out of the plate
+  model.SetHoleGeometry(fdm::Model::Point(-3.0, -3.0),
+                        fdm::Model::Point(-2.0, -3.0),
+                        fdm::Model::Point(-2.0, -2.0));
+  return Integrate(model, SmoothTotalTime);
+}
+
+RunResult RunTube(double delta, Order order) {
+  fdm::Model model(Width, Height, delta, TubeTimeDelta);
+  model.SetDiffusivity(Diffusivity);
+  model.SetSpatialOrder(order);
+  model.SetInitialCondition(20);
+  bench::SetTubeRestrictions(model);
+  bench::SetTubeHole(model);
+  return Integrate(model, TubeTotalTime);
+}
+
+void PrintHeader() {
+  std::cout << std::setw(10) << "dx" << std::setw(8) << "order"
+            << std::setw(12) << "time, s" << std::setw(14) << "max error"
+            << std::setw(14) << "rms error" << std::endl;
+}
+
+void PrintRow(double delta, Order order, double seconds, const Error &error) {
+  std::cout << std::setw(10) << delta << std::setw(8)
+            << (order == Order::Second ? 2 : 4) << std::setw(12) << seconds
+            << std::setw(14) << error.max << std::setw(14) << error.Rms()
+            << std::endl;
+}
+}  // anonymous namespace
+
+int main() {
+  std::cout << "Smooth plate, reference is the exact solution" << std::endl;
+  PrintHeader();
+  for (double delta : {1.0 / 4, 1.0 / 8, 1.0 / 16, 1.0 / 32}) {
+    for (auto order : {Order::Second, Order::Fourth}) {
+      RunResult run = RunSmooth(delta, order);
+      size_t rows = run.result.layer.size() / run.result.cols;
+      Error error;
+      for (size_t j = 0; j < rows; ++j) {
+        for (size_t i = 0; i < run.result.cols; ++i) {
+          error.Add(run.result.layer[j * run.result.cols + i] -
+                    SmoothSolution(static_cast<double>(i) * delta,
+                                   static_cast<double>(j) * delta,
+                                   SmoothTotalTime, delta));
+        }
+      }
+      PrintRow(delta, order, run.seconds, error);
+    }
+  }
+
+  std::cout << std::endl
+            << "Tube, reference is the same order on dx = " << ReferenceDelta
+            << std::endl;
+  PrintHeader();
+  for (auto order : {Order::Second, Order::Fourth}) {
+    RunResult reference = RunTube(ReferenceDelta, order);
+    size_t reference_rows =
+        reference.result.layer.size() / reference.result.cols;
+    for (double delta : {1.0 / 4, 1.0 / 8, 1.0 / 16, 1.0 / 32}) {
+      RunResult run = RunTube(delta, order);
+      auto ratio = static_cast<size_t>(delta / ReferenceDelta);
+      size_t rows = run.result.layer.size() / run.result.cols;
+      Error error;
+      for (size_t j = 0; j < rows && j * ratio < reference_rows; ++j) {
+        for (size_t i = 0; i < run.result.cols &&
+                           i * ratio < reference.result.cols;
+             ++i) {
+          error.Add(run.result.layer[j * run.result.cols + i] -
+                    reference.result
+                        .layer[j * ratio * reference.result.cols + i * ratio]);
+        }
+      }
+      PrintRow(delta, order, run.seconds, error);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "BenchmarkCommon.hpp"
+#include "Model.hpp"
+
+/*
+ * Time-to-solution of the explicit scheme against super time stepping
+ * with different amount of stages. All runs use the largest stable
+ * explicit step, errors are measured against the explicit solution with
+ * the step four times smaller.
+ */
+
+namespace {
+using bench::Height;
+using bench::RunResult;
+using bench::Width;
+
+constexpr double Delta = 1.0 / 32;
+constexpr double Diffusivity = 0.1;
+// a * dt * (1 / dx^2 + 1 / dy^2) = 1 / 2
+constexpr double TimeDelta = Delta * Delta / (4 * Diffusivity);
+constexpr double TotalTime = 20.0;
+
+RunResult Run(double time_delta, fdm::Model::TimeScheme scheme,
+              size_t stages) {
+  fdm::Model model(Width, Height, Delta, time_delta);
+  model.SetDiffusivity(Diffusivity);
+  model.SetTimeScheme(scheme, stages);
+  model.SetInitialCondition(20);
+  bench::SetTubeRestrictions(model);
+  bench::SetTubeHole(model);
+  return bench::Integrate(model, TotalTime);
+}
+}  // anonymous namespace
+
+int main() {
+  std::cout << "Computing reference, dt = " << TimeDelta / 4 << std::endl;
+  RunResult reference =
+      Run(TimeDelta / 4, fdm::Model::TimeScheme::Explicit, 1);
+
+  std::cout << std::setw(10) << "stages" << std::setw(14) << "time, s"
+            << std::setw(10) << "speedup" << std::setw(14) << "max error"
+            << std::endl;
+  double explicit_seconds = 0.0;
+  for (size_t stages : {0, 4, 8, 16, 32}) {
+    RunResult run =
+        stages == 0 ? Run(TimeDelta, fdm::Model::TimeScheme::Explicit, 1)
+                    : Run(TimeDelta, fdm::Model::TimeScheme::SuperTimeStepping,
+                          stages);
+    if (stages == 0) {
+      explicit_seconds = run.seconds;
+    }
+    double max_error = 0.0;
+    for (size_t i = 0; i < run.result.layer.size(); ++i) {
+      max_error = std::max(max_error, std::abs(run.result.layer[i] -
+                                               reference.result.layer[i]));
+    }
+    std::cout << std::setw(10)
+              << (stages == 0 ? "explicit" : std::to_string(stages))
+              << std::setw(14) << run.seconds << std::setw(10)
+              << explicit_seconds / run.seconds << std::setw(14) << max_error
+              << std::endl;
+  }
+  return 0;
+}
@@ -1,6 +1,7 @@
 #ifndef FINITEDIFFERENCEMETHOD_CALCULATIONUTILS_HPP_
 #define FINITEDIFFERENCEMETHOD_CALCULATIONUTILS_HPP_
 
+#include <array>
 #include <memory>
 #include <tuple>
 
@@ -74,6 +75,12 @@ constexpr size_t UP_RESTRICTION = 0;
 constexpr size_t DOWN_RESTRICTION = 1;
 constexpr size_t LEFT_RESTRICTION = 2;
 constexpr size_t RIGHT_RESTRICTION = 3;
+// Restrictions on the ends of tube, used by the 3D model.
+template <typename ModelNodeType>
+using EndRestrictionsStorageType =
+    std::array<BoundaryRestrincionPointerType<ModelNodeType>, 2>;
+constexpr size_t FRONT_RESTRICTION = 0;
+constexpr size_t BACK_RESTRICTION = 1;
 }  // namespace restr
 
 namespace equations {
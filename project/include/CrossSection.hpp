@@ -0,0 +1,92 @@
+#ifndef FINITEDIFFERENCEMETHOD_CROSSSECTION_HPP_
+#define FINITEDIFFERENCEMETHOD_CROSSSECTION_HPP_
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fdm {
+/*
+ * Geometry of the tube cross-section: rectangle with a triangular hole.
+ * It is shared by the plate model and the extruded 3D tube model, which
+ * apply the same hole handling on every cross-section.
+ */
+namespace geometry {
+/*
+ * Actually I could use std::pair, but in my opinion Point
+ * is more representative.
+ */
+struct Point {
+  double x;
+  double y;
+  Point() : x(0.0), y(0.0) {}
+  Point(double _x, double _y) : x(_x), y(_y) {}
+};
+
+/*
+ * Triangular hole in the center of tube. I think
+ * good idea to store it in fixed size array.
+ */
+using HoleGeometry = std::array<Point, 3>;
+
+struct NodeIndex {
+  size_t row;
+  size_t col;
+};
+
+// Nodes [col_begin, col_end) of the row
+struct NodeRun {
+  size_t row;
+  size_t col_begin;
+  size_t col_end;
+};
+
+// Node on the hole border and its inner neighbor, if there is one
+struct BorderNode {
+  NodeIndex node;
+  NodeIndex inner;
+  bool has_inner;
+};
+
+class CrossSection {
+ public:
+  CrossSection(const HoleGeometry &hole_geometry, double x_delta,
+               double y_delta);
+
+  /**
+   * Find all inner (not outer boundary) nodes of the rows x cols mesh,
+   * that lie in the hole or on its border.
+   * @param rows amount of mesh rows
+   * @param cols amount of mesh columns
+   * @param hole_nodes nodes in the hole
+   * @param border_nodes nodes on the hole border with inner neighbors
+   */
+  void Classify(size_t rows, size_t cols, std::vector<NodeIndex> &hole_nodes,
+                std::vector<BorderNode> &border_nodes) const;
+  // Same, but the hole nodes are grouped in runs of the same row, so the
+  // big hole doesn't cost memory per node
+  void Classify(size_t rows, size_t cols, std::vector<NodeRun> &hole_runs,
+                std::vector<BorderNode> &border_nodes) const;
+
+  // Bellow functions helps to determine hole and boundary points related to
+  // hole
+  [[nodiscard]] bool PointInHole(Point point) const;
+  [[nodiscard]] bool PointOnBorder(Point point) const;
+  [[nodiscard]] std::pair<bool, NodeIndex> GetInnerNeighbor(
+      size_t x_shift, size_t y_shift) const;
+
+ private:
+  HoleGeometry m_hole_geometry;
+  double m_x_delta;
+  double m_y_delta;
+
+  // Calculates auxiliary values for PointInHole and PointOnBorder function
+  [[nodiscard]] std::tuple<double, double, double> CalcCheckValues(
+      Point point) const;
+};
+}  // namespace geometry
+}  // namespace fdm
+
+#endif  // FINITEDIFFERENCEMETHOD_CROSSSECTION_HPP_
@@ -0,0 +1,207 @@
+#ifndef FINITEDIFFERENCEMETHOD_HEATMAPSTORAGE_HPP_
+#define FINITEDIFFERENCEMETHOD_HEATMAPSTORAGE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SolutionStorage.hpp"
+
+namespace fdm {
+namespace solution {
+namespace image {
+struct Rgb {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+};
+
+/**
+ * Piecewise linear palette, the same thing as gnuplot's
+ * "set palette defined (...)". Stop positions are normalized to [0, 1]
+ * and colors are precomputed in the lookup table, so mapping of the node
+ * is a single multiplication and load.
+ */
+class Palette {
+ public:
+  struct Stop {
+    double position;
+    double r;
+    double g;
+    double b;
+  };
+
+  explicit Palette(const std::vector<Stop> &stops);
+
+  // Palette of StaticGnuplotHeatmapStorage
+  static Palette GnuplotHeatmap();
+
+  [[nodiscard]] Rgb operator()(double normalized) const {
+    if (!(normalized > 0.0)) {
+      return m_table.front();
+    }
+    if (normalized >= 1.0) {
+      return m_table.back();
+    }
+    return m_table[static_cast<size_t>(normalized * (TableSize - 1) + 0.5)];
+  }
+
+ private:
+  static constexpr size_t TableSize = 1024;
+  std::array<Rgb, TableSize> m_table;
+};
+
+// 8-bit RGB image, rows from top to bottom
+struct RgbImage {
+  size_t width = 0;
+  size_t height = 0;
+  std::vector<uint8_t> pixels;
+};
+
+enum class ImageFormat { Ppm, Png };
+
+/*
+ * Writers throw exceptions::FileNotOpenException, if the file can't
+ * be written. PNG is written without compression (stored deflate
+ * blocks), so there is no dependency on zlib and writing costs the
+ * same as PPM.
+ */
+void WritePpm(const std::string &file_name, const RgbImage &image);
+void WritePng(const std::string &file_name, const RgbImage &image);
+void WriteImage(const std::string &file_name, const RgbImage &image,
+                ImageFormat format);
+}  // namespace image
+
+/**
+ * Storage, that renders committed layers into heatmap image frames by
+ * itself, without text dump and gnuplot run. Every FrameEvery-th
+ * committed layer is averaged in Downsample x Downsample blocks, mapped
+ * through the palette and written as <prefix>_<frame>.<ppm|png>.
+ * Like gnuplot's pm3d map, the first mesh row is at the bottom of the
+ * image. Color range is taken from each frame, unless it is fixed by
+ * SetRange (fixed range is what you want for animations).
+ *
+ * @tparam MeshNodesType specify mesh nodes type
+ */
+template <typename MeshNodesType>
+class HeatmapFrameStorage : public SolutionStorageBase<MeshNodesType> {
+ public:
+  using StringType = std::string;
+
+  explicit HeatmapFrameStorage(
+      const StringType &file_prefix,
+      image::ImageFormat format = image::ImageFormat::Png)
+      : m_file_output_prefix(file_prefix),
+        m_format(format),
+        m_palette(image::Palette::GnuplotHeatmap()) {}
+
+  void SetFrameEvery(size_t frame_every) {
+    m_frame_every = std::max<size_t>(frame_every, 1);
+  }
+  void SetDownsample(size_t downsample) {
+    m_downsample = std::max<size_t>(downsample, 1);
+  }
+  void SetRange(double range_min, double range_max) {
+    m_fixed_range = true;
+    m_range_min = range_min;
+    m_range_max = range_max;
+  }
+  void SetPalette(const image::Palette &palette) { m_palette = palette; }
+
+  void CommitLayer(
+      const typename SolutionStorageBase<MeshNodesType>::MeshPointerType
+          &mesh_ptr) override {
+    size_t layer = m_layers_committed++;
+    if (layer % m_frame_every != 0) {
+      return;
+    }
+    Render(*mesh_ptr);
+    image::WriteImage(FrameFileName(m_frames_written++), m_image, m_format);
+  }
+
+  [[nodiscard]] size_t FramesWritten() const { return m_frames_written; }
+
+ private:
+  StringType m_file_output_prefix;
+  image::ImageFormat m_format;
+  image::Palette m_palette;
+  size_t m_frame_every = 1;
+  size_t m_downsample = 1;
+  bool m_fixed_range = false;
+  double m_range_min = 0.0;
+  double m_range_max = 1.0;
+
+  size_t m_layers_committed = 0;
+  size_t m_frames_written = 0;
+  // Buffers are reused between frames
+  std::vector<MeshNodesType> m_row;
+  std::vector<double> m_blocks;
+  image::RgbImage m_image;
+
+  StringType FrameFileName(size_t frame) const {
+    char number[16];
+    std::snprintf(number, sizeof(number), "_%06zu", frame);
+    return m_file_output_prefix + number +
+           (m_format == image::ImageFormat::Png ? ".png" : ".ppm");
+  }
+
+  void Render(const mtrx::base::MatrixBase<MeshNodesType> &mesh) {
+    size_t rows = mesh.SizeRows();
+    size_t cols = mesh.SizeCols();
+    size_t width = (cols + m_downsample - 1) / m_downsample;
+    size_t height = (rows + m_downsample - 1) / m_downsample;
+
+    // Average nodes in blocks
+    m_row.resize(cols);
+    m_blocks.assign(width * height, 0.0);
+    for (size_t i = 0; i < rows; ++i) {
+      mesh.CopyRow(i, m_row.data());
+      double *block_row = m_blocks.data() + (i / m_downsample) * width;
+      for (size_t j = 0; j < cols; ++j) {
+        block_row[j / m_downsample] += static_cast<double>(m_row[j]);
+      }
+    }
+    for (size_t y = 0; y < height; ++y) {
+      size_t block_rows = std::min(m_downsample, rows - y * m_downsample);
+      for (size_t x = 0; x < width; ++x) {
+        size_t block_cols = std::min(m_downsample, cols - x * m_downsample);
+        m_blocks[y * width + x] /=
+            static_cast<double>(block_rows * block_cols);
+      }
+    }
+
+    double range_min = m_range_min;
+    double range_max = m_range_max;
+    if (!m_fixed_range) {
+      auto [min_it, max_it] =
+          std::minmax_element(m_blocks.begin(), m_blocks.end());
+      range_min = min_it == m_blocks.end() ? 0.0 : *min_it;
+      range_max = max_it == m_blocks.end() ? 1.0 : *max_it;
+    }
+    double scale =
+        range_max > range_min ? 1.0 / (range_max - range_min) : 0.0;
+
+    // Map through the palette, first mesh row goes to the image bottom
+    m_image.width = width;
+    m_image.height = height;
+    m_image.pixels.resize(width * height * 3);
+    for (size_t y = 0; y < height; ++y) {
+      const double *block_row = m_blocks.data() + y * width;
+      uint8_t *pixel = m_image.pixels.data() + (height - 1 - y) * width * 3;
+      for (size_t x = 0; x < width; ++x) {
+        image::Rgb color = m_palette((block_row[x] - range_min) * scale);
+        *pixel++ = color.r;
+        *pixel++ = color.g;
+        *pixel++ = color.b;
+      }
+    }
+  }
+};
+}  // namespace solution
+}  // namespace fdm
+
+#endif  // FINITEDIFFERENCEMETHOD_HEATMAPSTORAGE_HPP_
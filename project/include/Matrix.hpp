@@ -9,6 +9,8 @@
 #include <type_traits>
 #include <vector>
 
+#include "MatrixAllocation.hpp"
+
 namespace mtrx {
 namespace exceptions {
 class BaseMatrixException : public std::exception {
@@ -44,6 +46,16 @@ class MatrixBase {
   virtual size_t SizeRows() const = 0;
   virtual size_t SizeCols() const = 0;
   [[maybe_unused]] virtual void FillMatrix([[maybe_unused]] Tp val) {}
+  /**
+   * Copy the whole row into destination, that has at least SizeCols()
+   * elements. Implementations, that store rows contiguously, should
+   * override it: the row costs one virtual call instead of one per node.
+   */
+  virtual void CopyRow(size_t row, Tp *destination) const {
+    for (size_t col = 0; col < SizeCols(); ++col) {
+      destination[col] = GetValue(row, col);
+    }
+  }
 
   virtual ~MatrixBase() = default;
 };
@@ -63,6 +75,61 @@ class MatrixDynamicBase : public MatrixBase<Tp> {
 };
 }  // namespace base
 
+/**
+ * Rectangular block of the matrix: half-open ranges of rows and columns.
+ * Every matrix, that could be used by the model, splits itself into tiles
+ * in its storage order. Kernels traverse the matrix tile by tile, and
+ * workers get contiguous ranges of tile indices (see alloc::WorkerRows),
+ * so sweeps follow the memory layout whatever it is. Every row segment
+ * [col_begin, col_end) of the tile is contiguous in memory, so kernels
+ * may take &At(row, col_begin) and walk the segment with the pointer.
+ * At is the raw access for computational kernels, that every such matrix
+ * defines: there are no range checks, unlike GetValue and SetValue.
+ */
+struct Tile {
+  size_t row_begin;
+  size_t row_end;
+  size_t col_begin;
+  size_t col_end;
+};
+
+/**
+ * Range of matrix tiles in storage order, so you can simply write
+ * for (const Tile &tile : matrix.Tiles()) { ... }
+ *
+ * @tparam MatrixClass matrix, that defines TileCount and GetTile
+ */
+template <typename MatrixClass>
+class TileRange {
+ public:
+  class Iterator {
+   public:
+    Iterator(const MatrixClass *matrix, size_t index)
+        : m_matrix(matrix), m_index(index) {}
+    Tile operator*() const { return m_matrix->GetTile(m_index); }
+    Iterator &operator++() {
+      ++m_index;
+      return *this;
+    }
+    bool operator!=(const Iterator &other) const {
+      return m_index != other.m_index;
+    }
+
+   private:
+    const MatrixClass *m_matrix;
+    size_t m_index;
+  };
+
+  explicit TileRange(const MatrixClass *matrix) : m_matrix(matrix) {}
+  [[nodiscard]] Iterator begin() const { return Iterator(m_matrix, 0); }
+  [[nodiscard]] Iterator end() const {
+    return Iterator(m_matrix, m_matrix->TileCount());
+  }
+
+ private:
+  const MatrixClass *m_matrix;
+};
+
 /**
  * Simplest matrix implementation. Matrix class in this program maintains
  * only basic operations and using as structure for easy to store and
@@ -85,6 +152,23 @@ class Matrix : public base::MatrixBase<Tp> {
   const Tp &GetValue(size_t row, size_t col) const override;
   [[nodiscard]] virtual size_t SizeRows() const override { return Rows; }
   [[nodiscard]] virtual size_t SizeCols() const override { return Cols; }
+  void FillMatrix(Tp val) override { m_storage.fill(val); }
+  void CopyRow(size_t row, Tp *destination) const override {
+    std::copy_n(m_storage.begin() + MatrixAccessor(row, 0), Cols, destination);
+  }
+
+  [[nodiscard]] Tp &At(size_t row, size_t col) {
+    return m_storage[MatrixAccessor(row, col)];
+  }
+  [[nodiscard]] const Tp &At(size_t row, size_t col) const {
+    return m_storage[MatrixAccessor(row, col)];
+  }
+  [[nodiscard]] Tp *RowData(size_t row) {
+    return m_storage.data() + MatrixAccessor(row, 0);
+  }
+  [[nodiscard]] const Tp *RowData(size_t row) const {
+    return m_storage.data() + MatrixAccessor(row, 0);
+  }
 
   Matrix() = default;
 
@@ -126,24 +210,34 @@ class MatrixCreatorStatic {
   }
 };
 
-template <typename Tp>
+/**
+ * Dynamic matrix. Storage layout and placement are defined by
+ * allocation policy (see MatrixAllocation.hpp): rows may be padded,
+ * so the distance between rows is Stride() elements, not SizeCols().
+ *
+ * @tparam Tp matrix elements type
+ * @tparam AllocationPolicy storage allocation policy
+ */
+template <typename Tp, typename AllocationPolicy = alloc::DefaultPolicy>
 class MatrixDynamic : public base::MatrixDynamicBase<Tp> {
  public:
   using Type = Tp;
-  using MatrixStorageType = std::vector<Type>;
+  using Policy = AllocationPolicy;
+  using MatrixStorageType =
+      std::vector<Type, typename Policy::template Allocator<Type>>;
 
   void SetRows(size_t rows) override {
     m_rows = rows;
-    m_storage.resize(m_rows * m_cols);
+    Allocate();
   }
   void SetCols(size_t cols) override {
     m_cols = cols;
-    m_storage.resize(m_rows * m_cols);
+    Allocate();
   }
   void SetSize(size_t rows, size_t cols) {
     m_rows = rows;
     m_cols = cols;
-    m_storage.resize(rows * cols);
+    Allocate();
   }
   [[nodiscard]] size_t SizeRows() const override { return m_rows; }
   [[nodiscard]] size_t SizeCols() const override { return m_cols; }
@@ -151,61 +245,157 @@ class MatrixDynamic : public base::MatrixDynamicBase<Tp> {
   void SetValue(size_t row, size_t col, Tp &&val) override;
   const Tp &GetValue(size_t row, size_t col) const override;
   void FillMatrix(Tp val) override;
+  void CopyRow(size_t row, Tp *destination) const override {
+    std::copy_n(RowData(row), m_cols, destination);
+  }
 
-  MatrixDynamic() = default;
-  MatrixDynamic(size_t rows, size_t cols) : m_cols(m_cols), m_rows(m_rows) {
-    SetSize(rows, cols);
+  /**
+   * Set amount of workers, that will process this matrix. If policy
+   * requires parallel first touch, storage is allocated again and
+   * touched by the workers with the same row partitioning as
+   * alloc::WorkerRows gives. Matrix values are kept: new storage is
+   * touched by copying the old one.
+   * @param workers amount of workers
+   */
+  void SetWorkers(size_t workers) {
+    workers = std::max<size_t>(workers, 1);
+    if (workers != m_workers) {
+      m_workers = workers;
+      Relocate();
+    }
+  }
+  [[nodiscard]] size_t Workers() const { return m_workers; }
+
+  [[nodiscard]] Tp &At(size_t row, size_t col) {
+    return m_storage[MatrixAccessor(row, col)];
+  }
+  [[nodiscard]] const Tp &At(size_t row, size_t col) const {
+    return m_storage[MatrixAccessor(row, col)];
+  }
+  [[nodiscard]] size_t Stride() const { return m_stride; }
+  [[nodiscard]] Tp *RowData(size_t row) {
+    return m_storage.data() + row * m_stride;
+  }
+  [[nodiscard]] const Tp *RowData(size_t row) const {
+    return m_storage.data() + row * m_stride;
   }
 
+  // Row-major matrix is stored as sequence of single row tiles
+  [[nodiscard]] size_t TileCount() const { return m_rows; }
+  [[nodiscard]] Tile GetTile(size_t index) const {
+    return {index, index + 1, 0, m_cols};
+  }
+  [[nodiscard]] TileRange<MatrixDynamic> Tiles() const {
+    return TileRange<MatrixDynamic>(this);
+  }
+
+  MatrixDynamic() = default;
+  MatrixDynamic(size_t rows, size_t cols) { SetSize(rows, cols); }
+
  private:
   MatrixStorageType m_storage;
-  size_t m_cols;
-  size_t m_rows;
+  size_t m_cols = 0;
+  size_t m_rows = 0;
+  size_t m_stride = 0;
+  size_t m_workers = 1;
 
   [[nodiscard]] bool CheckAccess(size_t row, size_t col) const {
     return col < m_cols && row < m_rows;
   }
 
   [[nodiscard]] size_t MatrixAccessor(size_t row, size_t col) const {
-    return row * m_cols + col;
+    return row * m_stride + col;
   }
+
+  // Get new storage and place its pages with first touch
+  void Allocate();
+  void Touch(Tp val);
+  // Place storage again for the current workers, values are kept
+  void Relocate();
 };
 
-template <typename Tp>
-void MatrixDynamic<Tp>::SetValue(size_t row, size_t col, Tp &&val) {
+template <typename Tp, typename AllocationPolicy>
+void MatrixDynamic<Tp, AllocationPolicy>::SetValue(size_t row, size_t col,
+                                                   Tp &&val) {
   if (!CheckAccess(row, col)) {
     throw exceptions::MatrixSizeException();
   }
   m_storage[MatrixAccessor(row, col)] = std::forward<Tp>(val);
 }
 
-template <typename Tp>
-const Tp &MatrixDynamic<Tp>::GetValue(size_t row, size_t col) const {
+template <typename Tp, typename AllocationPolicy>
+const Tp &MatrixDynamic<Tp, AllocationPolicy>::GetValue(size_t row,
+                                                        size_t col) const {
   if (!CheckAccess(row, col)) {
     throw exceptions::MatrixSizeException();
   }
   return m_storage[MatrixAccessor(row, col)];
 }
 
-template <typename Tp>
-void MatrixDynamic<Tp>::FillMatrix(Tp val) {
-  std::fill(m_storage.begin(), m_storage.end(), val);
+template <typename Tp, typename AllocationPolicy>
+void MatrixDynamic<Tp, AllocationPolicy>::FillMatrix(Tp val) {
+  Touch(val);
+}
+
+template <typename Tp, typename AllocationPolicy>
+void MatrixDynamic<Tp, AllocationPolicy>::Allocate() {
+  m_stride = alloc::PaddedCols<Policy, Tp>(m_cols);
+  // Swap with fresh storage instead of resize: old pages must be
+  // released, otherwise first touch don't place anything.
+  MatrixStorageType storage;
+  storage.resize(m_rows * m_stride);
+  m_storage.swap(storage);
+  Touch(Tp());
+}
+
+template <typename Tp, typename AllocationPolicy>
+void MatrixDynamic<Tp, AllocationPolicy>::Touch(Tp val) {
+  size_t workers = Policy::ParallelFirstTouch ? m_workers : 1;
+  alloc::ParallelRows(m_rows, workers, [this, val](size_t begin, size_t end) {
+    std::fill(m_storage.begin() + begin * m_stride,
+              m_storage.begin() + end * m_stride, val);
+  });
+}
+
+template <typename Tp, typename AllocationPolicy>
+void MatrixDynamic<Tp, AllocationPolicy>::Relocate() {
+  if constexpr (Policy::ParallelFirstTouch) {
+    MatrixStorageType storage;
+    storage.resize(m_storage.size());
+    alloc::ParallelRows(m_rows, m_workers, [&](size_t begin, size_t end) {
+      std::copy(m_storage.begin() + begin * m_stride,
+                m_storage.begin() + end * m_stride,
+                storage.begin() + begin * m_stride);
+    });
+    m_storage.swap(storage);
+  }
 }
 
-class MatrixCreatorDynamic {
+template <typename AllocationPolicy>
+class BasicMatrixCreatorDynamic {
  public:
   template <typename Tp>
-  using TargetType = MatrixDynamic<Tp>;
+  using TargetType = MatrixDynamic<Tp, AllocationPolicy>;
   template <typename Tp>
   using BaseType = base::MatrixDynamicBase<Tp>;
   template <typename Tp>
   using Pointer = std::shared_ptr<BaseType<Tp>>;
+  template <typename Tp>
+  using TargetPointer = std::shared_ptr<TargetType<Tp>>;
 
   template <typename Tp>
   Pointer<Tp> Build() {
     return std::forward<Pointer<Tp>>(std::make_unique<TargetType<Tp>>());
   }
+
+  // Same as Build, but keeps the concrete type for raw access.
+  template <typename Tp>
+  TargetPointer<Tp> BuildTarget() {
+    return std::make_shared<TargetType<Tp>>();
+  }
 };
+
+using MatrixCreatorDynamic = BasicMatrixCreatorDynamic<alloc::DefaultPolicy>;
 }  // namespace mtrx
 
 #endif  // FINITEDIFFERENCEMETHOD_MATRIX_HPP_
@@ -0,0 +1,354 @@
+#ifndef FINITEDIFFERENCEMETHOD_MATRIXALLOCATION_HPP_
+#define FINITEDIFFERENCEMETHOD_MATRIXALLOCATION_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+/*
+ * Allocation policies for the dynamic matrices. Mesh layers are the only
+ * really big objects in the program, so the way they are placed in memory
+ * matters much more than anything else: aligned rows for vector loads,
+ * padded rows, huge pages for TLB pressure and, on multi-socket machines,
+ * the thread that touches a page first decides which socket owns it.
+ */
+namespace mtrx {
+namespace alloc {
+constexpr size_t CacheLineSize = 64;
+constexpr size_t HugePageSize = size_t{2} << 20;
+
+/**
+ * Half-open range of rows, that belongs to the worker with given index.
+ * Rows are split in contiguous blocks, first (rows % workers) workers get
+ * one extra row. Every part of the program, that spreads the mesh between
+ * workers (first touch, layer sweeps), have to use this function, so each
+ * worker mostly touches pages placed on its own memory node.
+ *
+ * @param rows amount of rows to split
+ * @param workers amount of workers
+ * @param worker worker index in [0, workers)
+ * @return pair of first and past-the-last row
+ */
+inline std::pair<size_t, size_t> WorkerRows(size_t rows, size_t workers,
+                                            size_t worker) {
+  size_t block = rows / workers;
+  size_t extra = rows % workers;
+  size_t begin = worker * block + std::min(worker, extra);
+  size_t end = begin + block + (worker < extra ? 1 : 0);
+  return {begin, end};
+}
+
+/**
+ * Persistent workers of the process. Worker w is the same thread for the
+ * whole run, and on Linux it is pinned to the w-th CPU of the process
+ * affinity mask, so the rows it has touched first stay on its memory node
+ * and it doesn't pay for thread start on every layer.
+ *
+ * Calls from different threads are served one after another. Call from
+ * inside of the worker runs all the blocks in that worker.
+ */
+class WorkerPool {
+ public:
+  static WorkerPool &Instance() {
+    static WorkerPool pool;
+    return pool;
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto &thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  /**
+   * Run task(context, w) for every w in [0, workers) and wait for all of
+   * them. Task of the worker w always runs in the same thread.
+   *
+   * @param workers amount of workers
+   * @param task plain function, so the call doesn't allocate
+   * @param context argument of the task
+   */
+  void Run(size_t workers, void (*task)(void *, size_t), void *context) {
+    if (InsideWorker()) {
+      for (size_t w = 0; w < workers; ++w) {
+        task(context, w);
+      }
+      return;
+    }
+
+    std::lock_guard<std::mutex> dispatch(m_dispatch);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_threads.size() < workers) {
+      size_t index = m_threads.size();
+      m_threads.emplace_back([this, index]() { Loop(index); });
+    }
+    m_task = task;
+    m_context = context;
+    m_workers = workers;
+    m_pending = workers;
+    m_error = nullptr;
+    ++m_generation;
+    m_start.notify_all();
+    m_done.wait(lock, [this]() { return m_pending == 0; });
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+  }
+
+ private:
+  std::mutex m_dispatch;
+  std::mutex m_mutex;
+  std::condition_variable m_start;
+  std::condition_variable m_done;
+  std::vector<std::thread> m_threads;
+  void (*m_task)(void *, size_t) = nullptr;
+  void *m_context = nullptr;
+  size_t m_workers = 0;
+  size_t m_pending = 0;
+  size_t m_generation = 0;
+  bool m_stop = false;
+  std::exception_ptr m_error;
+
+  WorkerPool() = default;
+
+  static bool &InsideWorker() {
+    thread_local bool inside = false;
+    return inside;
+  }
+
+  void Loop(size_t index) {
+    InsideWorker() = true;
+    Pin(index);
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      m_start.wait(lock, [&]() { return m_stop || m_generation != seen; });
+      if (m_stop) {
+        return;
+      }
+      seen = m_generation;
+      if (index >= m_workers) {
+        continue;
+      }
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        m_task(m_context, index);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      if (error && !m_error) {
+        m_error = error;
+      }
+      if (--m_pending == 0) {
+        m_done.notify_one();
+      }
+    }
+  }
+
+  static void Pin([[maybe_unused]] size_t index) {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 ||
+        CPU_COUNT(&allowed) == 0) {
+      return;
+    }
+    size_t target = index % static_cast<size_t>(CPU_COUNT(&allowed));
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        CPU_SET(cpu, &pinned);
+        // Unpinned worker is still correct, so failure is not an error.
+        pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
+        return;
+      }
+    }
+#endif
+  }
+};
+
+/**
+ * Run callable for every worker's block of rows. Block of the worker w is
+ * always processed by the worker w of WorkerPool, so the first touch and
+ * the layer sweeps with the same partitioning run on the same CPU. Single
+ * worker runs in the calling thread.
+ *
+ * @tparam Callable callable with signature void(size_t begin, size_t end)
+ * @param rows amount of rows to split
+ * @param workers amount of workers
+ * @param callable the work
+ */
+template <typename Callable>
+void ParallelRows(size_t rows, size_t workers, Callable &&callable) {
+  if (workers <= 1) {
+    callable(size_t{0}, rows);
+    return;
+  }
+
+  struct Context {
+    Callable &callable;
+    size_t rows;
+    size_t workers;
+  } context{callable, rows, workers};
+  WorkerPool::Instance().Run(
+      workers,
+      [](void *ptr, size_t worker) {
+        auto &context = *static_cast<Context *>(ptr);
+        auto [begin, end] =
+            WorkerRows(context.rows, context.workers, worker);
+        context.callable(begin, end);
+      },
+      &context);
+}
+
+/**
+ * Allocator, that returns memory aligned on Alignment boundary and
+ * (optionally) asks the kernel to back big blocks with transparent
+ * huge pages. Elements are default-initialized on construction, so
+ * std::vector::resize doesn't touch the memory - the matrix does
+ * the first touch itself.
+ *
+ * @tparam Tp element type
+ * @tparam Alignment required alignment in bytes
+ * @tparam HugePages advise transparent huge pages for big blocks
+ */
+template <typename Tp, size_t Alignment = CacheLineSize,
+          bool HugePages = false>
+class AlignedAllocator {
+ public:
+  using value_type = Tp;
+
+  template <typename Up>
+  struct rebind {
+    using other = AlignedAllocator<Up, Alignment, HugePages>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <typename Up>
+  AlignedAllocator(
+      const AlignedAllocator<Up, Alignment, HugePages> &) noexcept {}
+
+  Tp *allocate(size_t n) {
+    size_t bytes = n * sizeof(Tp);
+    void *ptr =
+        ::operator new(bytes, std::align_val_t{BlockAlignment(bytes)});
+    if constexpr (HugePages) {
+      AdviseHugePages(ptr, bytes);
+    }
+    return static_cast<Tp *>(ptr);
+  }
+
+  void deallocate(Tp *ptr, size_t n) noexcept {
+    ::operator delete(ptr,
+                      std::align_val_t{BlockAlignment(n * sizeof(Tp))});
+  }
+
+  template <typename Up, typename... Args>
+  void construct(Up *ptr, Args &&...args) {
+    if constexpr (sizeof...(Args) == 0) {
+      ::new (static_cast<void *>(ptr)) Up;
+    } else {
+      ::new (static_cast<void *>(ptr)) Up(std::forward<Args>(args)...);
+    }
+  }
+
+  template <typename Up>
+  bool operator==(const AlignedAllocator<Up, Alignment, HugePages> &) const {
+    return true;
+  }
+
+ private:
+  static constexpr size_t BlockAlignment(size_t bytes) {
+    if constexpr (HugePages) {
+      if (bytes >= HugePageSize) {
+        return HugePageSize;
+      }
+    }
+    return Alignment < alignof(Tp) ? alignof(Tp) : Alignment;
+  }
+
+  static void AdviseHugePages([[maybe_unused]] void *ptr,
+                              [[maybe_unused]] size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    size_t advised = bytes - bytes % HugePageSize;
+    if (advised != 0) {
+      // It's only advice, so failure is not an error.
+      madvise(ptr, advised, MADV_HUGEPAGE);
+    }
+#endif
+  }
+};
+
+/*
+ * Policy defines the allocator, row alignment (in bytes, rows are padded
+ * to multiple of this value) and whether first touch should be done by
+ * workers in parallel.
+ */
+
+// Behaves exactly as plain std::vector storage.
+struct PlainPolicy {
+  template <typename Tp>
+  using Allocator = std::allocator<Tp>;
+  static constexpr size_t RowAlignment = 1;
+  static constexpr bool ParallelFirstTouch = false;
+};
+
+// Cache line aligned and padded rows, parallel first touch.
+struct AlignedPolicy {
+  template <typename Tp>
+  using Allocator = AlignedAllocator<Tp, CacheLineSize>;
+  static constexpr size_t RowAlignment = CacheLineSize;
+  static constexpr bool ParallelFirstTouch = true;
+};
+
+// Same as AlignedPolicy, but big layers are backed by huge pages.
+struct HugePagePolicy {
+  template <typename Tp>
+  using Allocator = AlignedAllocator<Tp, CacheLineSize, true>;
+  static constexpr size_t RowAlignment = CacheLineSize;
+  static constexpr bool ParallelFirstTouch = true;
+};
+
+using DefaultPolicy = AlignedPolicy;
+
+/**
+ * Amount of elements in the padded row.
+ * @tparam Policy allocation policy
+ * @tparam Tp element type
+ * @param cols amount of meaningful elements in row
+ */
+template <typename Policy, typename Tp>
+constexpr size_t PaddedCols(size_t cols) {
+  constexpr size_t per_line =
+      Policy::RowAlignment > sizeof(Tp) ? Policy::RowAlignment / sizeof(Tp)
+                                        : 1;
+  return (cols + per_line - 1) / per_line * per_line;
+}
+}  // namespace alloc
+}  // namespace mtrx
+
+#endif  // FINITEDIFFERENCEMETHOD_MATRIXALLOCATION_HPP_
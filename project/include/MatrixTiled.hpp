@@ -0,0 +1,303 @@
+#ifndef FINITEDIFFERENCEMETHOD_MATRIXTILED_HPP_
+#define FINITEDIFFERENCEMETHOD_MATRIXTILED_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "MatrixAllocation.hpp"
+
+namespace mtrx {
+/*
+ * Order, in which tiles follow each other in memory. Inside the tile
+ * elements are always stored row by row.
+ */
+enum class TileOrder { RowMajor, Morton };
+
+/**
+ * Matrix, that stores elements in square TileSize x TileSize tiles. On
+ * wide meshes vertical neighbors of the node are far away from it in
+ * row-major storage, but inside the tile they are only TileSize elements
+ * away, so the whole stencil neighborhood stays in cache. With Morton
+ * order neighbor tiles are also close to each other in memory.
+ *
+ * Edge tiles are padded up to the full size, the padding is never
+ * accessed by the matrix interface.
+ *
+ * @tparam Tp matrix elements type
+ * @tparam TileSize tile side, has to be power of two
+ * @tparam Order order of tiles in memory
+ * @tparam AllocationPolicy storage allocation policy
+ */
+template <typename Tp, size_t TileSize = 32,
+          TileOrder Order = TileOrder::RowMajor,
+          typename AllocationPolicy = alloc::DefaultPolicy>
+class MatrixTiled : public base::MatrixDynamicBase<Tp> {
+ public:
+  static_assert(std::has_single_bit(TileSize),
+                "Tile size has to be power of two");
+
+  using Type = Tp;
+  using Policy = AllocationPolicy;
+  using MatrixStorageType =
+      std::vector<Type, typename Policy::template Allocator<Type>>;
+
+  static constexpr size_t TileSide = TileSize;
+  static constexpr size_t TileArea = TileSize * TileSize;
+
+  void SetRows(size_t rows) override {
+    m_rows = rows;
+    Allocate();
+  }
+  void SetCols(size_t cols) override {
+    m_cols = cols;
+    Allocate();
+  }
+  void SetSize(size_t rows, size_t cols) {
+    m_rows = rows;
+    m_cols = cols;
+    Allocate();
+  }
+  [[nodiscard]] size_t SizeRows() const override { return m_rows; }
+  [[nodiscard]] size_t SizeCols() const override { return m_cols; }
+
+  void SetValue(size_t row, size_t col, Tp &&val) override;
+  const Tp &GetValue(size_t row, size_t col) const override;
+  void FillMatrix(Tp val) override;
+  void CopyRow(size_t row, Tp *destination) const override;
+
+  /**
+   * Same as MatrixDynamic::SetWorkers, but workers get contiguous
+   * ranges of tiles in storage order.
+   * @param workers amount of workers
+   */
+  void SetWorkers(size_t workers) {
+    workers = std::max<size_t>(workers, 1);
+    if (workers != m_workers) {
+      m_workers = workers;
+      Relocate();
+    }
+  }
+  [[nodiscard]] size_t Workers() const { return m_workers; }
+
+  [[nodiscard]] Tp &At(size_t row, size_t col) {
+    return m_storage[MatrixAccessor(row, col)];
+  }
+  [[nodiscard]] const Tp &At(size_t row, size_t col) const {
+    return m_storage[MatrixAccessor(row, col)];
+  }
+
+  [[nodiscard]] size_t TileCount() const { return m_tile_order.size(); }
+  [[nodiscard]] Tile GetTile(size_t index) const;
+  [[nodiscard]] TileRange<MatrixTiled> Tiles() const {
+    return TileRange<MatrixTiled>(this);
+  }
+  /*
+   * Elements of the tile with given index. Rows of the tile are
+   * TileSize elements away from each other.
+   */
+  [[nodiscard]] Tp *TileData(size_t index) {
+    return m_storage.data() + index * TileArea;
+  }
+  [[nodiscard]] const Tp *TileData(size_t index) const {
+    return m_storage.data() + index * TileArea;
+  }
+
+  MatrixTiled() = default;
+  MatrixTiled(size_t rows, size_t cols) { SetSize(rows, cols); }
+
+ private:
+  static constexpr size_t TileShift = std::countr_zero(TileSize);
+  static constexpr size_t TileMask = TileSize - 1;
+
+  MatrixStorageType m_storage;
+  size_t m_cols = 0;
+  size_t m_rows = 0;
+  size_t m_tiles_x = 0;
+  size_t m_tiles_y = 0;
+  size_t m_workers = 1;
+  // Tile coordinates (ty * m_tiles_x + tx) in storage order
+  std::vector<size_t> m_tile_order;
+  // Storage slot of the tile with coordinates (ty * m_tiles_x + tx)
+  std::vector<size_t> m_tile_slot;
+
+  [[nodiscard]] bool CheckAccess(size_t row, size_t col) const {
+    return col < m_cols && row < m_rows;
+  }
+
+  [[nodiscard]] size_t MatrixAccessor(size_t row, size_t col) const {
+    size_t slot =
+        m_tile_slot[(row >> TileShift) * m_tiles_x + (col >> TileShift)];
+    return slot * TileArea + ((row & TileMask) << TileShift) +
+           (col & TileMask);
+  }
+
+  static uint64_t MortonCode(uint32_t y, uint32_t x);
+  void BuildTileOrder();
+  void Allocate();
+  void Touch(Tp val);
+  void Relocate();
+};
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::SetValue(
+    size_t row, size_t col, Tp &&val) {
+  if (!CheckAccess(row, col)) {
+    throw exceptions::MatrixSizeException();
+  }
+  m_storage[MatrixAccessor(row, col)] = std::forward<Tp>(val);
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+const Tp &MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::GetValue(
+    size_t row, size_t col) const {
+  if (!CheckAccess(row, col)) {
+    throw exceptions::MatrixSizeException();
+  }
+  return m_storage[MatrixAccessor(row, col)];
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::FillMatrix(Tp val) {
+  Touch(val);
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::CopyRow(
+    size_t row, Tp *destination) const {
+  // Row consists of contiguous segments, one per tile column
+  for (size_t col = 0; col < m_cols; col += TileSize) {
+    std::copy_n(&At(row, col), std::min(TileSize, m_cols - col),
+                destination + col);
+  }
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+Tile MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::GetTile(
+    size_t index) const {
+  size_t coord = m_tile_order[index];
+  size_t row_begin = (coord / m_tiles_x) * TileSize;
+  size_t col_begin = (coord % m_tiles_x) * TileSize;
+  return {row_begin, std::min(row_begin + TileSize, m_rows), col_begin,
+          std::min(col_begin + TileSize, m_cols)};
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+uint64_t MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::MortonCode(
+    uint32_t y, uint32_t x) {
+  // Interleave bits: x takes even bits, y takes odd ones
+  auto spread = [](uint64_t v) {
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::BuildTileOrder() {
+  size_t tiles = m_tiles_x * m_tiles_y;
+  m_tile_order.resize(tiles);
+  for (size_t coord = 0; coord < tiles; ++coord) {
+    m_tile_order[coord] = coord;
+  }
+  if constexpr (Order == TileOrder::Morton) {
+    // Tile grid is not necessary square with power of two side, so just
+    // sort existing tiles by their codes.
+    std::sort(m_tile_order.begin(), m_tile_order.end(),
+              [this](size_t lhs, size_t rhs) {
+                return MortonCode(static_cast<uint32_t>(lhs / m_tiles_x),
+                                  static_cast<uint32_t>(lhs % m_tiles_x)) <
+                       MortonCode(static_cast<uint32_t>(rhs / m_tiles_x),
+                                  static_cast<uint32_t>(rhs % m_tiles_x));
+              });
+  }
+  m_tile_slot.resize(tiles);
+  for (size_t slot = 0; slot < tiles; ++slot) {
+    m_tile_slot[m_tile_order[slot]] = slot;
+  }
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::Allocate() {
+  m_tiles_x = (m_cols + TileMask) >> TileShift;
+  m_tiles_y = (m_rows + TileMask) >> TileShift;
+  BuildTileOrder();
+  MatrixStorageType storage;
+  storage.resize(m_tiles_x * m_tiles_y * TileArea);
+  m_storage.swap(storage);
+  Touch(Tp());
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::Touch(Tp val) {
+  size_t workers = Policy::ParallelFirstTouch ? m_workers : 1;
+  alloc::ParallelRows(TileCount(), workers,
+                      [this, val](size_t begin, size_t end) {
+                        std::fill(m_storage.begin() + begin * TileArea,
+                                  m_storage.begin() + end * TileArea, val);
+                      });
+}
+
+template <typename Tp, size_t TileSize, TileOrder Order,
+          typename AllocationPolicy>
+void MatrixTiled<Tp, TileSize, Order, AllocationPolicy>::Relocate() {
+  if constexpr (Policy::ParallelFirstTouch) {
+    MatrixStorageType storage;
+    storage.resize(m_storage.size());
+    alloc::ParallelRows(TileCount(), m_workers,
+                        [&](size_t begin, size_t end) {
+                          std::copy(m_storage.begin() + begin * TileArea,
+                                    m_storage.begin() + end * TileArea,
+                                    storage.begin() + begin * TileArea);
+                        });
+    m_storage.swap(storage);
+  }
+}
+
+/**
+ * Builder for the tiled matrices, has the same interface as
+ * MatrixCreatorDynamic, so it can be used as Model::MatrixBuilder.
+ */
+template <size_t TileSize = 32, TileOrder Order = TileOrder::RowMajor,
+          typename AllocationPolicy = alloc::DefaultPolicy>
+class MatrixCreatorTiled {
+ public:
+  template <typename Tp>
+  using TargetType = MatrixTiled<Tp, TileSize, Order, AllocationPolicy>;
+  template <typename Tp>
+  using BaseType = base::MatrixDynamicBase<Tp>;
+  template <typename Tp>
+  using Pointer = std::shared_ptr<BaseType<Tp>>;
+  template <typename Tp>
+  using TargetPointer = std::shared_ptr<TargetType<Tp>>;
+
+  template <typename Tp>
+  Pointer<Tp> Build() {
+    return std::make_shared<TargetType<Tp>>();
+  }
+
+  template <typename Tp>
+  TargetPointer<Tp> BuildTarget() {
+    return std::make_shared<TargetType<Tp>>();
+  }
+};
+}  // namespace mtrx
+
+#endif  // FINITEDIFFERENCEMETHOD_MATRIXTILED_HPP_
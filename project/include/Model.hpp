@@ -2,16 +2,21 @@
 #define FINITEDIFFERENCEMETHOD_MODEL_HPP_
 
 #include <array>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include "CalculationUtils.hpp"
+#include "CrossSection.hpp"
 #include "Matrix.hpp"
+#include "MatrixTiled.hpp"
 #include "SolutionStorage.hpp"
 
 // As you'll see, I'm a big fan of readable aliases. Don't swear if this makes
@@ -31,29 +36,40 @@ class Model {
    * your own data types that implement the interface declared
    * in the Matrix.h file, change the aliases declared here.
    * This is done so as not to complicate the understanding of
-   * the program code.
+   * the program code. For example, the mesh stored in tiles is
+   * mtrx::MatrixCreatorTiled<32, mtrx::TileOrder::Morton>.
    */
   using ModelNodeType = double;
   constexpr static ModelNodeType DefModelVal = 0.0;
+  constexpr static double DefDiffusivity = 0.1;
+  constexpr static size_t DefActiveTileSize = 32;
+  constexpr static size_t DefStages = 8;
   using MatrixBuilder = mtrx::MatrixCreatorDynamic;
-  using MatrixPointerType = MatrixBuilder::Pointer<ModelNodeType>;
+  using MatrixPointerType = MatrixBuilder::TargetPointer<ModelNodeType>;
+
+  using Point = geometry::Point;
+  using HoleGeometry = geometry::HoleGeometry;
 
   /*
-   * Actually I could use std::pair, but in my opinion Point
-   * is more representative.
-   */
-  struct Point {
-	ModelNodeType x;
-	ModelNodeType y;
-	Point() : x(DefModelVal), y(DefModelVal) {}
-	Point(ModelNodeType _x, ModelNodeType _y) : x(_x), y(_y) {}
-  };
+   * Order of the spatial approximation of the inner nodes. Fourth order
+   * uses 9-point wide cross stencil and falls back to the second order
+   * near the hole, outer restrictions and material interfaces.
+   */
+  enum class SpatialOrder { Second, Fourth };
 
   /*
-   * Triangular hole in the center of tube. I think
-   * good idea to store it in fixed size array.
+   * Time integration scheme. Explicit makes the forward Euler step dt.
+   * SuperTimeStepping is the first order Runge-Kutta-Legendre scheme
+   * (RKL1): s stages of the same explicit operator make the stable step
+   * dt * s (s + 1) / 2, where dt is still limited by the explicit
+   * stability checks. So the work per unit of time drops as 1 / s.
    */
-  using HoleGeometry = std::array<Point, 3>;
+  enum class TimeScheme { Explicit, SuperTimeStepping };
+
+  // Thermal diffusivity (a) of the material in the given point of plate
+  using DiffusivityFieldType = std::function<double(Point)>;
+  // Temperature in the given point of plate
+  using TemperatureFieldType = std::function<ModelNodeType(Point)>;
 
   // Finally, after all this NECESSARY definitions - code!!!
   Model()
@@ -65,7 +81,9 @@ class Model {
 		m_nodes_y(0),
 		m_x_delta(0.0),
 		m_y_delta(0.0),
-		m_time_delta(0.0) {}
+		m_time_delta(0.0),
+		m_workers(1),
+		m_diffusivity([](Point) { return DefDiffusivity; }) {}
 
   Model(double width, double height, double delta_n, double time_delta);
 
@@ -77,11 +95,143 @@ class Model {
    */
   void SetHoleGeometry(Point p1, Point p2, Point p3);
 
+  /**
+   * Set amount of workers, that compute each time layer. Mesh rows are
+   * split between workers, and the mesh memory is placed again with the
+   * same partitioning. Mesh values are kept.
+   * @param workers amount of worker threads
+   */
+  void SetWorkers(size_t workers);
+
+  /**
+   * Set thermal diffusivity of the plate. Field is sampled in every
+   * node before the first integrated layer (twice, if it varies: first
+   * to check it, then row by row into the weights) and turned into the
+   * stencil weights, so heterogeneous plate costs per step the same as
+   * homogeneous one.
+   * @param diffusivity constant or field of the diffusivity
+   */
+  void SetDiffusivity(double diffusivity);
+  void SetDiffusivity(const DiffusivityFieldType &diffusivity);
+
+  /**
+   * Set the order of spatial approximation, second by default. Fourth
+   * order reaches the same error on the much coarser mesh, but has
+   * stricter stability limit: a * dt * (1 / dx^2 + 1 / dy^2) <= 3 / 8.
+   * @param order spatial order
+   */
+  void SetSpatialOrder(SpatialOrder order);
+
+  /**
+   * Switch on incremental mode. Mesh is split into tiles and the tile is
+   * computed only if it or one of its neighbors changed more than epsilon
+   * on the previous layer, other tiles keep their values. So the work per
+   * layer is proportional to the part of the plate, that really changes.
+   * Zero epsilon switches the mode off (default).
+   * @param epsilon change, that is considered as quiescence
+   * @param tile_size tile side (tiled storage always uses its own tiles)
+   */
+  void SetIncremental(double epsilon, size_t tile_size = DefActiveTileSize);
+
+  /*
+   * Incremental mode statistics since SetIncremental: computed tiles
+   * against all tiles, and the upper bound of the maximum error, that
+   * skipped tiles introduced.
+   */
+  struct IncrementalStats {
+	size_t layers = 0;
+	size_t tiles_total = 0;
+	size_t tiles_computed = 0;
+	double error_bound = 0.0;
+  };
+  [[nodiscard]] IncrementalStats GetIncrementalStats() const {
+	return m_incremental_stats;
+  }
+
+  /**
+   * Set time integration scheme, explicit by default. Super time stepping
+   * commits one layer per super step and supports the second order
+   * stencil with two layers without incremental mode only. Outer
+   * restrictions are applied after every stage to the inner row of the
+   * same stage, so any of their kinds keeps the first order in time.
+   * @param scheme time integration scheme
+   * @param stages amount of stages of the super step
+   */
+  void SetTimeScheme(TimeScheme scheme, size_t stages = DefStages);
+
+  /*
+   * Configuration, that autotuning chooses. All candidates give the same
+   * results, they differ in speed only.
+   */
+  struct TuningConfig {
+	size_t workers = 1;
+	bool in_place = false;
+  };
+
+  /**
+   * Switch on autotuning. Before the first integrated layer model
+   * measures a few layers with every candidate configuration (amount of
+   * workers up to the hardware concurrency, in-place mode, if it is
+   * supported by the current mode) and applies the fastest one. Winner
+   * is saved in the cache file, keyed by the processor model, mesh shape
+   * and mode, so later runs with the same key just apply it. Measured
+   * layers are thrown away, results don't change.
+   * @param cache_file tuning cache, empty name switches autotuning off
+   */
+  void SetAutotune(const std::string &cache_file);
+  [[nodiscard]] TuningConfig GetTuningConfig() const {
+	return {m_workers, m_in_place};
+  }
+
+  /**
+   * Switch on in-place integration. Only one mesh layer is kept and
+   * updated row by row, old rows, that the stencil still needs, are
+   * saved in a ring of four rows per worker. Results are the same as
+   * with two layers, and the memory is one mesh less: about one mesh
+   * instead of two for the homogeneous plate.
+   * Supports the second order stencil without incremental mode only.
+   * @param in_place keep one layer
+   */
+  void SetInPlace(bool in_place);
+
+  /*
+   * Per layer reductions, that the model can compute during the sweep
+   * instead of committing layers: temperature statistics over the plate
+   * (all nodes except the hole) and heat flux from the plate into the
+   * hole through its border, a * dT / dn integrated along the border.
+   */
+  struct ReductionRequest {
+	bool temperature = false;
+	bool hole_flux = false;
+  };
+  struct LayerReductions {
+	double time = 0.0;
+	ModelNodeType min = 0.0;
+	ModelNodeType max = 0.0;
+	ModelNodeType mean = 0.0;
+	double hole_flux = 0.0;
+  };
+
+  /**
+   * Request per layer reductions. Every worker reduces the nodes right
+   * after it has computed them, while they are in cache, so the series
+   * costs no additional pass over the mesh and TimeIntegrate can run with
+   * PlaceholderStorage. Quantities, that are not requested, stay zero.
+   * Clears the series collected before.
+   * @param request quantities to reduce
+   */
+  void SetReductions(const ReductionRequest &request);
+  [[nodiscard]] const std::vector<LayerReductions> &GetReductions() const {
+	return m_reductions;
+  }
+
   /**
    * Sets the initial conditions of the model
-   * @param init_conditions Desired initial condition
+   * @param init_conditions Desired initial condition, constant or field
+   * sampled in every node
    */
   void SetInitialCondition(ModelNodeType init_conditions);
+  void SetInitialCondition(const TemperatureFieldType &init_conditions);
 
   /*
    * Just the few setters for restrictions, that have not specific behavior.
@@ -116,27 +266,217 @@ class Model {
   double m_y_delta;
 
   double m_time_delta;
+  size_t m_workers;
 
   HoleGeometry m_hole_geometry;
   restr::BoundaryRestrictionsStorageType<ModelNodeType> m_outer_restrictions;
   restr::BoundaryRestrincionPointerType<ModelNodeType> m_inner_restriction;
+  DiffusivityFieldType m_diffusivity;
+
+  /*
+   * Precomputed stencil. Inner nodes are updated by the weighted
+   * 5-point formula: T + sum of w_face * (T_neighbor - T) over four faces.
+   * Weight of the face is a_face * dt / d^2, it is stored once per face:
+   * m_face_x(j, i) is the face between (j, i) and (j, i + 1), m_face_y(j, i)
+   * is the face between (j, i) and (j + 1, i). Face arrays have the same
+   * layout as the mesh. Homogeneous plate has no face arrays, all its
+   * rows share the single rows of weights m_uniform_face_x/y. Hole nodes
+   * and nodes on the hole border are overwritten after the sweep using
+   * the lists bellow.
+   */
+  using NodeIndex = geometry::NodeIndex;
+  using NodeRun = geometry::NodeRun;
+  using BorderNode = geometry::BorderNode;
+  bool m_stencil_ready = false;
+  MatrixPointerType m_face_x;
+  MatrixPointerType m_face_y;
+  bool m_uniform_stencil = false;
+  std::vector<ModelNodeType> m_uniform_face_x;
+  std::vector<ModelNodeType> m_uniform_face_y;
+  std::vector<NodeRun> m_hole_runs;
+  std::vector<BorderNode> m_border_nodes;
+
+  /*
+   * Nodes with fourth order stencil, grouped in runs of the same row
+   * and material. Runs of the row j are
+   * [m_fourth_row_runs[j], m_fourth_row_runs[j + 1]).
+   */
+  struct StencilRun {
+	size_t row;
+	size_t col_begin;
+	size_t col_end;
+	double diffusivity;
+	double x_weight;
+	double y_weight;
+  };
+  SpatialOrder m_spatial_order = SpatialOrder::Second;
+
+  std::vector<StencilRun> m_fourth_runs;
+  std::vector<size_t> m_fourth_row_runs;
+
+  // Incremental mode state, tiles are in row-major order
+  double m_incremental_epsilon = 0.0;
+  size_t m_active_tile_size = DefActiveTileSize;
+  size_t m_active_tiles_x = 0;
+  size_t m_active_tiles_y = 0;
+  std::vector<mtrx::Tile> m_active_tiles;
+  std::vector<size_t> m_active_list;
+  // Changed more than epsilon on the last layer
+  std::vector<uint8_t> m_tile_changed;
+  // Both layers of the skipped tile are equal
+  std::vector<uint8_t> m_tile_synced;
+  std::vector<ModelNodeType> m_tile_change;
+  IncrementalStats m_incremental_stats;
+
+  /*
+   * In-place mode state. Old values of the border inner neighbors are
+   * saved before every sweep in both modes.
+   */
+  constexpr static size_t SavedRowsPerWorker = 4;
+  bool m_in_place = false;
+  bool m_in_place_requested = false;
+  std::vector<ModelNodeType> m_saved_rows;
+  std::vector<ModelNodeType> m_border_inner;
+
+  /*
+   * Super time stepping state. Stage is Y_j = mu Y_{j-1} + nu Y_{j-2} +
+   * weight (E(Y_{j-1}) - Y_{j-1}), plain stage is just E(Y_{j-1}).
+   */
+  struct StageCoefficients {
+	double mu = 1.0;
+	double nu = 0.0;
+	double weight = 1.0;
+	bool plain = true;
+  };
+  TimeScheme m_time_scheme = TimeScheme::Explicit;
+  size_t m_stages = DefStages;
+  StageCoefficients m_stage;
+
+  /*
+   * Autotuning state. Candidate is measured on at least TuneMinLayers
+   * and at most TuneMaxLayers layers, until TuneSeconds are spent.
+   */
+  constexpr static size_t TuneMinLayers = 3;
+  constexpr static size_t TuneMaxLayers = 100;
+  constexpr static double TuneSeconds = 0.05;
+  struct LayerSnapshot {
+	std::vector<ModelNodeType> present;
+	std::vector<ModelNodeType> last;
+	IncrementalStats incremental_stats;
+  };
+  std::string m_tuning_cache_file;
+  std::string m_tuned_key;
+
+  /*
+   * Reductions state. Plate nodes, that the stencil computes, are
+   * grouped in runs of the row: runs of the row j are
+   * [m_plate_row_runs[j], m_plate_row_runs[j + 1]). Hole border and
+   * outer boundary nodes are reduced, where they are computed.
+   */
+  struct ReductionPartial {
+	ModelNodeType min = std::numeric_limits<ModelNodeType>::infinity();
+	ModelNodeType max = -std::numeric_limits<ModelNodeType>::infinity();
+	ModelNodeType sum = 0.0;
 
-  // Bellow functions helps to determine hole and boundary points related to
-  // hole
-  [[nodiscard]] bool PointInHole(Point point) const;
-  [[nodiscard]] bool PointOnBorder(Point point) const;
-  // Calculates auxiliary values for PointInHole and PointOnBorder function
-  [[nodiscard]] std::tuple<ModelNodeType, ModelNodeType, ModelNodeType>
-  CalcCheckValues(
-	  Point point) const;  // sorry for that, it's just a formatter :)))
-  ModelNodeType GetInnerNeighbor(size_t x_shift, size_t y_shift);
+	void Add(ModelNodeType value) {
+	  min = std::min(min, value);
+	  max = std::max(max, value);
+	  sum += value;
+	}
+	// Locals keep neighbor partials of other workers out of the loop
+	void AddRange(const ModelNodeType *values, size_t count) {
+	  ModelNodeType range_min = min;
+	  ModelNodeType range_max = max;
+	  ModelNodeType range_sum = sum;
+	  for (size_t i = 0; i < count; ++i) {
+		range_min = std::min(range_min, values[i]);
+		range_max = std::max(range_max, values[i]);
+		range_sum += values[i];
+	  }
+	  min = range_min;
+	  max = range_max;
+	  sum = range_sum;
+	}
+	void Merge(const ReductionPartial &other) {
+	  min = std::min(min, other.min);
+	  max = std::max(max, other.max);
+	  sum += other.sum;
+	}
+  };
+  struct PlateRun {
+	size_t col_begin;
+	size_t col_end;
+  };
+  ReductionRequest m_reduction_request;
+  std::vector<LayerReductions> m_reductions;
+  double m_reduction_time = 0.0;
+  std::vector<PlateRun> m_plate_runs;
+  std::vector<size_t> m_plate_row_runs;
+  size_t m_plate_nodes = 0;
+  // Face diffusivity between the border node and its inner neighbor
+  std::vector<double> m_border_diffusivity;
+  bool m_reduce_temperature = false;
+  bool m_reduce_hole_flux = false;
+  ReductionPartial m_layer_partial;
+  double m_layer_hole_flux = 0.0;
+  std::vector<ReductionPartial> m_worker_partials;
+  // Incremental mode keeps partials of the skipped tiles
+  std::vector<ReductionPartial> m_tile_partials;
+
+  // Sample geometry and diffusivity into the precomputed stencil
+  class StencilWindow;
+  void PrepareStencil();
+  void PrepareFourthOrderRuns(const StencilWindow &window, size_t row,
+							  double x_weight, double y_weight);
+  void PreparePlateRuns(const StencilWindow &window, size_t row);
 
   /*
    * Calculation methods. Just use for improve code readability and
    * decompose layer calculation.
    */
+  void ComputeLayer(ModelNodeType tube_flow);
   void ComputeBoundaries();
   void ComputePlate(ModelNodeType tube_flow);
+  void ComputePlateTile(const mtrx::Tile &tile);
+  void ComputeStageTile(const mtrx::Tile &tile);
+  template <typename Combine>
+  void ComputePlateTile(const mtrx::Tile &tile, Combine combine);
+  void IntegrateSuperSteps(
+	  double total_time, solution::SolutionStorageBase<ModelNodeType> &storage,
+	  ModelNodeType tube_flow);
+  void ComputeSuperStep(size_t stages, size_t explicit_steps,
+						ModelNodeType tube_flow);
+  void SwitchInPlace(bool in_place);
+  void ComputePlateInPlace();
+  // Face weights of the row segment, that starts in the given node
+  struct FaceRow {
+	const ModelNodeType *x;
+	const ModelNodeType *down;
+	const ModelNodeType *up;
+	ModelNodeType left_edge;
+  };
+  [[nodiscard]] FaceRow GetFaceRow(size_t row, size_t col) const;
+  void ComputeRowInPlace(size_t row, const ModelNodeType *down,
+						 const ModelNodeType *center, const ModelNodeType *up);
+  void PrepareActiveTiles();
+  void ComputeActiveTiles();
+  void UpdateActiveTiles();
+  void ComputeFourthOrderRun(const StencilRun &run, size_t col_begin,
+							 size_t col_end);
+  void AccumulatePlate(const mtrx::Tile &tile, ReductionPartial &partial) const;
+  void BeginLayerReductions(bool reduce);
+  void EmitReductions(double time_step);
+
+  void Autotune(ModelNodeType tube_flow);
+  [[nodiscard]] std::string TuningKey() const;
+  bool ParseTuningConfig(const std::string &value,
+						 TuningConfig &config) const;
+  [[nodiscard]] bool InPlaceTunable() const;
+  LayerSnapshot SaveLayers();
+  void RestoreLayers(const LayerSnapshot &snapshot, const TuningConfig &config);
+  void ApplyTuningConfig(const TuningConfig &config);
+  TuningConfig MeasureTuningConfigs(ModelNodeType tube_flow);
+  double MeasureLayer(ModelNodeType tube_flow);
 };
 
 namespace exceptions {
@@ -151,6 +491,27 @@ class WrongDeltaRel : std::exception {
 	return "Error: (dt / dx) ^ 2 > 1 / 2";
   }
 };
+
+class InPlaceUnsupported : std::exception {
+  [[nodiscard]] const char *what() const noexcept override {
+	return "Error: in-place mode needs the second order stencil without "
+		   "incremental mode";
+  }
+};
+
+class TimeSchemeUnsupported : std::exception {
+  [[nodiscard]] const char *what() const noexcept override {
+	return "Error: super time stepping needs the second order stencil on "
+		   "two layers without incremental mode";
+  }
+};
+
+class WrongDiffusivity : std::exception {
+  [[nodiscard]] const char *what() const noexcept override {
+	return "Error: a < 0 or a * dt * (1 / dx ^ 2 + 1 / dy ^ 2) > 1 / 2 "
+		   "(3 / 8 for the fourth order) in some node";
+  }
+};
 }  // namespace exceptions
 }  // namespace fdm
 
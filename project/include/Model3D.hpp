@@ -0,0 +1,136 @@
+#ifndef FINITEDIFFERENCEMETHOD_MODEL3D_HPP_
+#define FINITEDIFFERENCEMETHOD_MODEL3D_HPP_
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "CalculationUtils.hpp"
+#include "CrossSection.hpp"
+#include "Matrix.hpp"
+#include "Model.hpp"
+#include "SlabStore.hpp"
+#include "SolutionStorage.hpp"
+
+namespace fdm {
+/**
+ * Tube with a triangular hole, extruded along z axis. Every z-slab is the
+ * cross-section of the plate Model, with the same hole and restriction
+ * handling, and slabs are connected by the 7-point explicit stencil.
+ * Outer restrictions take the nearest inner row or column of the new
+ * layer, as in Model, so with zero flux through the tube ends every slab
+ * is the plate Model layer.
+ *
+ * Model never holds the whole tube: time layer lives in the slab store
+ * and a step streams it slab by slab. Only three slabs of the last
+ * layer (z - 1, z, z + 1), the slab being read ahead and two result
+ * slabs are resident, so memory doesn't depend on the tube length.
+ */
+class Model3D {
+ public:
+  using ModelNodeType = Model::ModelNodeType;
+  constexpr static double DefDiffusivity = Model::DefDiffusivity;
+  using SlabType = mtrx::MatrixDynamic<ModelNodeType>;
+  using SlabPointerType = std::shared_ptr<SlabType>;
+  using SlabStorePointerType =
+      std::shared_ptr<slab::SlabStoreBase<ModelNodeType>>;
+  using Point = geometry::Point;
+  using HoleGeometry = geometry::HoleGeometry;
+
+  /**
+   * @param width cross-section width
+   * @param height cross-section height
+   * @param length tube length
+   * @param delta_n mesh step in all directions
+   * @param time_delta time step
+   * @param store where the time layer lives, in memory by default
+   */
+  Model3D(double width, double height, double length, double delta_n,
+          double time_delta, SlabStorePointerType store = nullptr);
+
+  void SetHoleGeometry(Point p1, Point p2, Point p3);
+  void SetDiffusivity(double diffusivity);
+  void SetWorkers(size_t workers);
+  void SetInitialCondition(ModelNodeType init_conditions);
+
+  void SetOuterRestrictions(
+      const restr::BoundaryRestrictionsStorageType<ModelNodeType>
+          &restrictions);
+  void SetInnerRestrictions(
+      const restr::BoundaryRestrincionPointerType<ModelNodeType> &restriction);
+  void SetEndRestrictions(
+      const restr::EndRestrictionsStorageType<ModelNodeType> &restrictions);
+
+  // Slab, that TimeIntegrate commits to the storage on every layer
+  void SetMonitoredSlab(size_t slab);
+  [[nodiscard]] size_t SizeSlabs() const { return m_nodes_z; }
+
+  void TimeIntegrate(double total_time,
+                     solution::SolutionStorageBase<ModelNodeType> &storage,
+                     ModelNodeType tube_flow);
+  void SaveResult(solution::SolutionStorageBase<ModelNodeType> &storage,
+                  size_t slab);
+
+ private:
+  using NodeIndex = geometry::NodeIndex;
+  using BorderNode = geometry::BorderNode;
+  // Last layer slabs z - 1, z, z + 1 and the one read ahead
+  constexpr static size_t LastLayerSlabs = 4;
+
+  size_t m_nodes_x;
+  size_t m_nodes_y;
+  size_t m_nodes_z;
+  double m_delta;
+  double m_time_delta;
+  double m_diffusivity;
+  size_t m_workers;
+  size_t m_monitored_slab;
+
+  HoleGeometry m_hole_geometry;
+  restr::BoundaryRestrictionsStorageType<ModelNodeType> m_outer_restrictions;
+  restr::BoundaryRestrincionPointerType<ModelNodeType> m_inner_restriction;
+  restr::EndRestrictionsStorageType<ModelNodeType> m_end_restrictions;
+
+  SlabStorePointerType m_store;
+  std::array<SlabPointerType, LastLayerSlabs> m_last_slabs;
+  SlabPointerType m_result_slab;
+  SlabPointerType m_end_slab;
+
+  bool m_section_ready = false;
+  std::vector<NodeIndex> m_hole_nodes;
+  std::vector<BorderNode> m_border_nodes;
+
+  [[nodiscard]] SlabPointerType MakeSlab() const;
+  void ReadSlab(size_t z, SlabType &slab);
+  void WriteSlab(size_t z, const SlabType &slab);
+  void PrepareSection();
+
+  void Step(solution::SolutionStorageBase<ModelNodeType> &storage,
+            ModelNodeType tube_flow);
+  void ComputeSlab(const SlabType &back, const SlabType &center,
+                   const SlabType &front, SlabType &result,
+                   ModelNodeType tube_flow);
+  void ComputeSectionBoundaries(SlabType &slab);
+  void ComputeEndSlab(const restr::BoundaryRestrincionPointerType<
+                          ModelNodeType> &restriction,
+                      const SlabType &inner, SlabType &result);
+};
+
+namespace exceptions {
+class WrongSlabsAmount : std::exception {
+  [[nodiscard]] const char *what() const noexcept override {
+	return "Error: tube has less than 3 slabs";
+  }
+};
+
+class WrongSlabIndex : std::exception {
+  [[nodiscard]] const char *what() const noexcept override {
+	return "Error: slab index is out of the tube";
+  }
+};
+}  // namespace exceptions
+}  // namespace fdm
+
+#endif  // FINITEDIFFERENCEMETHOD_MODEL3D_HPP_
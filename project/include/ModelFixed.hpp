@@ -0,0 +1,205 @@
+#ifndef FINITEDIFFERENCEMETHOD_MODELFIXED_HPP_
+#define FINITEDIFFERENCEMETHOD_MODELFIXED_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "CrossSection.hpp"
+#include "Matrix.hpp"
+#include "Model.hpp"
+#include "SolutionStorage.hpp"
+
+namespace fdm {
+/*
+ * Compile-time description of the model. Everything here is used as
+ * template parameters of ModelFixed, so these are plain structural types
+ * with constexpr helpers only.
+ */
+namespace fixed {
+enum class RestrictionKind { First, Second, Third };
+
+// Same formulas as restr::FirstKindRestriction and others
+struct Restriction {
+  RestrictionKind kind;
+  double constant;
+
+  [[nodiscard]] constexpr double operator()(double inner,
+                                            double delta) const {
+    switch (kind) {
+      case RestrictionKind::First:
+        return constant;
+      case RestrictionKind::Second:
+        return inner + constant * delta;
+      case RestrictionKind::Third:
+        return inner / (1 + delta);
+    }
+    return constant;
+  }
+};
+
+constexpr Restriction FirstKind(double constant = 0.0) {
+  return {RestrictionKind::First, constant};
+}
+constexpr Restriction SecondKind(double constant = 0.0) {
+  return {RestrictionKind::Second, constant};
+}
+constexpr Restriction ThirdKind() { return {RestrictionKind::Third, 0.0}; }
+
+struct Restrictions {
+  Restriction up;
+  Restriction down;
+  Restriction left;
+  Restriction right;
+  Restriction inner;
+};
+
+struct Grid {
+  size_t rows;
+  size_t cols;
+  double delta;
+  double time_delta;
+  double diffusivity;
+};
+
+// Mesh of the plate, the same one Model(width, height, ...) builds
+constexpr Grid MakeGrid(double width, double height, double delta_n,
+                        double time_delta,
+                        double diffusivity = Model::DefDiffusivity) {
+  return {static_cast<size_t>(height / delta_n),
+          static_cast<size_t>(width / delta_n), delta_n, time_delta,
+          diffusivity};
+}
+}  // namespace fixed
+
+/**
+ * Plate model for the mesh, that is known at compile time. It solves the
+ * same problem as Model with homogeneous diffusivity and second order
+ * stencil, and gives the same results, but sizes, stencil weight and
+ * restrictions are constants. So the sweep has constexpr bounds and
+ * strides, the weight lives in a register, and restrictions are inlined
+ * instead of virtual calls per boundary node.
+ *
+ * Hole geometry stays runtime parameter: hole and border nodes are
+ * classified once by geometry::CrossSection, as in Model.
+ *
+ * @tparam Mesh mesh sizes, steps and diffusivity (see fixed::MakeGrid)
+ * @tparam Restr outer and inner restrictions
+ */
+template <fixed::Grid Mesh, fixed::Restrictions Restr>
+class ModelFixed {
+ public:
+  using ModelNodeType = Model::ModelNodeType;
+  using Point = geometry::Point;
+  using HoleGeometry = geometry::HoleGeometry;
+
+  static constexpr size_t Rows = Mesh.rows;
+  static constexpr size_t Cols = Mesh.cols;
+  using MatrixType = mtrx::Matrix<ModelNodeType, Rows, Cols>;
+  using MatrixPointerType = std::shared_ptr<MatrixType>;
+
+  static_assert(Rows >= 3 && Cols >= 3, "Mesh has no inner nodes");
+  static_assert((Mesh.time_delta / Mesh.delta) *
+                        (Mesh.time_delta / Mesh.delta) <=
+                    0.5,
+                "Time and mesh steps relation is wrong");
+  static_assert(Mesh.diffusivity >= 0.0 &&
+                    2 * Mesh.diffusivity * Mesh.time_delta /
+                            (Mesh.delta * Mesh.delta) <=
+                        0.5,
+                "Explicit scheme is unstable with this diffusivity");
+
+  ModelFixed()
+      : m_mesh_ptr_present(std::make_shared<MatrixType>()),
+        m_mesh_ptr_last(std::make_shared<MatrixType>()) {
+    SetInitialCondition(Model::DefModelVal);
+  }
+
+  void SetHoleGeometry(Point p1, Point p2, Point p3) {
+    geometry::CrossSection section(HoleGeometry{p1, p2, p3}, Mesh.delta,
+                                   Mesh.delta);
+    section.Classify(Rows, Cols, m_hole_nodes, m_border_nodes);
+  }
+
+  void SetInitialCondition(ModelNodeType init_conditions) {
+    m_mesh_ptr_present->FillMatrix(init_conditions);
+    m_mesh_ptr_last->FillMatrix(init_conditions);
+  }
+
+  void TimeIntegrate(double total_time,
+                     solution::SolutionStorageBase<ModelNodeType> &storage,
+                     ModelNodeType tube_flow) {
+    storage.CommitLayer(m_mesh_ptr_present);
+    auto time_integrate_iterations =
+        static_cast<size_t>(total_time / Mesh.time_delta);
+    for (size_t t = 0; t < time_integrate_iterations; ++t) {
+      std::swap(m_mesh_ptr_last, m_mesh_ptr_present);
+      ComputePlate(tube_flow);
+      ComputeBoundaries();
+      storage.CommitLayer(m_mesh_ptr_present);
+    }
+    storage.CommitLayer(m_mesh_ptr_present);
+  }
+
+  void SaveResult(solution::SolutionStorageBase<ModelNodeType> &storage) const {
+    storage.CommitLayer(m_mesh_ptr_present);
+  }
+
+ private:
+  // Face weight of Model's stencil for the homogeneous plate
+  static constexpr ModelNodeType Weight =
+      Mesh.diffusivity * (Mesh.time_delta / (Mesh.delta * Mesh.delta));
+
+  MatrixPointerType m_mesh_ptr_present;
+  MatrixPointerType m_mesh_ptr_last;
+  std::vector<geometry::NodeIndex> m_hole_nodes;
+  std::vector<geometry::BorderNode> m_border_nodes;
+
+  void ComputePlate(ModelNodeType tube_flow) {
+    const MatrixType &last = *m_mesh_ptr_last;
+    MatrixType &present = *m_mesh_ptr_present;
+    for (size_t j = 1; j + 1 < Rows; ++j) {
+      const ModelNodeType *down = last.RowData(j - 1);
+      const ModelNodeType *center = last.RowData(j);
+      const ModelNodeType *up = last.RowData(j + 1);
+      ModelNodeType *result = present.RowData(j);
+      // Same order of operations as Model's StencilUpdate
+      for (size_t i = 1; i + 1 < Cols; ++i) {
+        result[i] = center[i] + Weight * (center[i - 1] - center[i]) +
+                    Weight * (center[i + 1] - center[i]) +
+                    Weight * (down[i] - center[i]) +
+                    Weight * (up[i] - center[i]);
+      }
+    }
+
+    for (const geometry::NodeIndex &node : m_hole_nodes) {
+      present.At(node.row, node.col) = tube_flow;
+    }
+    for (const geometry::BorderNode &border : m_border_nodes) {
+      ModelNodeType inner_value =
+          border.has_inner ? last.At(border.inner.row, border.inner.col)
+                           : 0.0;
+      present.At(border.node.row, border.node.col) =
+          Restr.inner(inner_value, Mesh.delta);
+    }
+  }
+
+  // Same traversal as Model::ComputeBoundaries
+  void ComputeBoundaries() {
+    MatrixType &present = *m_mesh_ptr_present;
+    for (size_t j = 1; j + 1 < Rows; ++j) {
+      present.At(j, 0) = Restr.left(present.At(j, 1), Mesh.delta);
+      present.At(j, Cols - 1) =
+          Restr.right(present.At(j, Cols - 2), Mesh.delta);
+    }
+    for (size_t i = 0; i < Cols; ++i) {
+      present.At(0, i) = Restr.down(present.At(1, i), Mesh.delta);
+      present.At(Rows - 1, i) =
+          Restr.up(present.At(Rows - 2, i), Mesh.delta);
+    }
+  }
+};
+}  // namespace fdm
+
+#endif  // FINITEDIFFERENCEMETHOD_MODELFIXED_HPP_
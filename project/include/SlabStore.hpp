@@ -0,0 +1,148 @@
+#ifndef FINITEDIFFERENCEMETHOD_SLABSTORE_HPP_
+#define FINITEDIFFERENCEMETHOD_SLABSTORE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fdm {
+/*
+ * The 3D model keeps only a few z-slabs of the tube in memory, all the
+ * other slabs live in the slab store. Model reads slabs one by one in
+ * increasing z order and writes every slab back after its new value is
+ * computed, so the store holds exactly one time layer.
+ */
+namespace slab {
+namespace exceptions {
+class SlabStoreException : public std::exception {
+ public:
+  [[nodiscard]] const char *what() const noexcept override {
+    return "Slab store input/output error occur";
+  }
+};
+}  // namespace exceptions
+
+/**
+ * @tparam NodeType type of the mesh nodes
+ */
+template <typename NodeType>
+class SlabStoreBase {
+ public:
+  /**
+   * Prepare the store for the new field. Previous content is lost.
+   * @param slabs amount of slabs
+   * @param slab_size amount of nodes in the slab
+   */
+  virtual void Resize(size_t slabs, size_t slab_size) = 0;
+  virtual void Read(size_t slab, NodeType *destination) = 0;
+  virtual void Write(size_t slab, const NodeType *source) = 0;
+  // Make all written slabs visible for the following reads
+  virtual void Sync() {}
+  /*
+   * Whether model should read the next slab in background while the
+   * current one is computed. Read and Write are called concurrently
+   * then, but never for the same slab.
+   */
+  [[nodiscard]] virtual bool ReadAhead() const { return false; }
+
+  virtual ~SlabStoreBase() = default;
+};
+
+// All slabs are kept in memory. Good for tubes, that fit in memory.
+template <typename NodeType>
+class MemorySlabStore : public SlabStoreBase<NodeType> {
+ public:
+  void Resize(size_t slabs, size_t slab_size) override {
+    m_slab_size = slab_size;
+    m_storage.assign(slabs * slab_size, NodeType());
+  }
+  void Read(size_t slab, NodeType *destination) override {
+    std::copy_n(m_storage.begin() + slab * m_slab_size, m_slab_size,
+                destination);
+  }
+  void Write(size_t slab, const NodeType *source) override {
+    std::copy_n(source, m_slab_size, m_storage.begin() + slab * m_slab_size);
+  }
+
+ private:
+  size_t m_slab_size = 0;
+  std::vector<NodeType> m_storage;
+};
+
+/*
+ * Slabs are kept in the binary file, so the tube size is limited by
+ * the disk, not by memory. Reads and writes use separate streams, so
+ * the next slab can be read while the previous one is written.
+ */
+template <typename NodeType>
+class FileSlabStore : public SlabStoreBase<NodeType> {
+ public:
+  using StringType = std::string;
+
+  explicit FileSlabStore(const StringType &file_name)
+      : m_file_name(file_name) {}
+
+  void Resize(size_t slabs, size_t slab_size) override {
+    m_slab_bytes = slab_size * sizeof(NodeType);
+    m_writer.close();
+    m_reader.close();
+    m_writer.open(m_file_name, std::ios::binary | std::ios::out |
+                                   std::ios::trunc);
+    if (!m_writer.is_open()) {
+      throw exceptions::SlabStoreException();
+    }
+    m_writer.close();
+    std::filesystem::resize_file(m_file_name, slabs * m_slab_bytes);
+    m_writer.open(m_file_name, std::ios::binary | std::ios::in |
+                                   std::ios::out);
+    m_reader.open(m_file_name, std::ios::binary | std::ios::in);
+    if (!m_writer.is_open() || !m_reader.is_open()) {
+      throw exceptions::SlabStoreException();
+    }
+  }
+
+  void Read(size_t slab, NodeType *destination) override {
+    m_reader.seekg(static_cast<std::streamoff>(slab * m_slab_bytes));
+    m_reader.read(reinterpret_cast<char *>(destination),
+                  static_cast<std::streamsize>(m_slab_bytes));
+    if (!m_reader) {
+      throw exceptions::SlabStoreException();
+    }
+  }
+
+  void Write(size_t slab, const NodeType *source) override {
+    m_writer.seekp(static_cast<std::streamoff>(slab * m_slab_bytes));
+    m_writer.write(reinterpret_cast<const char *>(source),
+                   static_cast<std::streamsize>(m_slab_bytes));
+    if (!m_writer) {
+      throw exceptions::SlabStoreException();
+    }
+  }
+
+  void Sync() override {
+    m_writer.flush();
+    // Drop data, that reader could have buffered before the writes
+    m_reader.sync();
+  }
+
+  [[nodiscard]] bool ReadAhead() const override { return true; }
+
+  ~FileSlabStore() override {
+    m_writer.close();
+    m_reader.close();
+  }
+
+ private:
+  StringType m_file_name;
+  size_t m_slab_bytes = 0;
+  std::fstream m_writer;
+  std::ifstream m_reader;
+};
+}  // namespace slab
+}  // namespace fdm
+
+#endif  // FINITEDIFFERENCEMETHOD_SLABSTORE_HPP_
@@ -1,12 +1,17 @@
 #ifndef FINITEDIFFERENCEMETHOD_SOLUTIONSTORAGE_HPP_
 #define FINITEDIFFERENCEMETHOD_SOLUTIONSTORAGE_HPP_
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <exception>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string_view>
+#include <system_error>
+#include <vector>
 
 #include "Matrix.hpp"
 
@@ -46,6 +51,104 @@ class SolutionStorageBase {
   virtual ~SolutionStorageBase() = default;
 };
 
+/**
+ * Text formatter of the mesh layers. Layer is written row by row: each
+ * node is followed by space, each row by new line, and the layer by one
+ * more empty line. Nodes are formatted with std::to_chars in general
+ * format with fixed precision (the same as default stream formatting
+ * gives, but without locale and stream state), and are right-aligned
+ * to the width, if it is set. Precision is clamped to max_digits10 of
+ * the node type: more digits don't carry any information. Text is
+ * collected in reusable buffer and goes to the stream by single write
+ * call, when the buffer is full or on Flush.
+ *
+ * @tparam MeshNodesType specify mesh nodes type
+ */
+template <typename MeshNodesType>
+class LayerTextWriter {
+ public:
+  using MeshType = mtrx::base::MatrixBase<MeshNodesType>;
+
+  static constexpr int DefaultPrecision = 6;
+  static constexpr size_t DefaultFlushSize = size_t{1} << 22;
+
+  explicit LayerTextWriter(std::ostream &output,
+                           int precision = DefaultPrecision, size_t width = 0,
+                           size_t flush_size = DefaultFlushSize)
+      : m_output(output),
+        m_precision(std::clamp(precision, 0, MaxPrecision)),
+        m_width(width),
+        m_flush_size(flush_size) {}
+
+  void WriteLayer(const MeshType &mesh) {
+    m_row.resize(mesh.SizeCols());
+    size_t node_size = std::max<size_t>(m_width, MaxNodeChars) + 1;
+    for (size_t i = 0; i < mesh.SizeRows(); ++i) {
+      Reserve(m_row.size() * node_size + 1);
+      mesh.CopyRow(i, m_row.data());
+      for (const MeshNodesType &node : m_row) {
+        WriteNode(node);
+        m_buffer[m_used++] = ' ';
+      }
+      m_buffer[m_used++] = '\n';
+    }
+    Reserve(1);
+    m_buffer[m_used++] = '\n';
+  }
+
+  void Flush() {
+    if (m_used != 0) {
+      m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+      m_used = 0;
+    }
+    m_output.flush();
+  }
+
+  ~LayerTextWriter() { Flush(); }
+
+ private:
+  static constexpr int MaxPrecision =
+      std::numeric_limits<MeshNodesType>::max_digits10;
+  // Sign, digits, point, exponent with its sign and digits
+  static constexpr size_t MaxNodeChars = MaxPrecision + 12;
+
+  std::ostream &m_output;
+  int m_precision;
+  size_t m_width;
+  size_t m_flush_size;
+  std::vector<MeshNodesType> m_row;
+  std::vector<char> m_buffer;
+  size_t m_used = 0;
+
+  // Guarantee, that there is space for size more chars in buffer
+  void Reserve(size_t size) {
+    if (m_used + size > m_flush_size && m_used != 0) {
+      m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+      m_used = 0;
+    }
+    if (m_used + size > m_buffer.size()) {
+      m_buffer.resize(std::max(m_used + size, m_flush_size));
+    }
+  }
+
+  void WriteNode(MeshNodesType node) {
+    char text[MaxNodeChars];
+    auto [end, error] = std::to_chars(text, text + MaxNodeChars, node,
+                                      std::chars_format::general,
+                                      m_precision);
+    if (error != std::errc()) {
+      throw exceptions::SolutionStorageException();
+    }
+    auto length = static_cast<size_t>(end - text);
+    if (length < m_width) {
+      std::memset(m_buffer.data() + m_used, ' ', m_width - length);
+      m_used += m_width - length;
+    }
+    std::memcpy(m_buffer.data() + m_used, text, length);
+    m_used += length;
+  }
+};
+
 /**
  * Simplest storage, that commit all integrated layers of
  * model in standard output
@@ -58,15 +161,13 @@ class StandardStreamStorage : public SolutionStorageBase<MeshNodesType> {
   void CommitLayer(
       const typename SolutionStorageBase<MeshNodesType>::MeshPointerType
           &mesh_ptr) override {
-    //    StandardStreamDefinition.precision(2);
-    for (size_t i = 0; i < mesh_ptr->SizeRows(); ++i) {
-      for (size_t j = 0; j < mesh_ptr->SizeCols(); ++j) {
-        StandardStreamDefinition << mesh_ptr->GetValue(i, j) << ' ';
-      }
-      StandardStreamDefinition << '\n';
-    }
-    StandardStreamDefinition << '\n';
+    m_writer.WriteLayer(*mesh_ptr);
+    // Standard output is shared with the rest of the program
+    m_writer.Flush();
   }
+
+ private:
+  LayerTextWriter<MeshNodesType> m_writer{StandardStreamDefinition};
 };
 
 template <typename MeshNodesType>
@@ -93,17 +194,11 @@ class StaticGnuplotHeatmapStorage : public SolutionStorageBase<MeshNodesType> {
   void CommitLayer(
       const typename SolutionStorageBase<MeshNodesType>::MeshPointerType
           &mesh_ptr) override {
-    std::ostream &StandardStreamDefinition = m_plot_output;
-    for (size_t i = 0; i < mesh_ptr->SizeRows(); ++i) {
-      for (size_t j = 0; j < mesh_ptr->SizeCols(); ++j) {
-        StandardStreamDefinition << std::setw(8) << mesh_ptr->GetValue(i, j) << ' ';
-      }
-      StandardStreamDefinition << '\n';
-    }
-    StandardStreamDefinition << '\n';
+    m_plot_writer.WriteLayer(*mesh_ptr);
   }
 
   ~StaticGnuplotHeatmapStorage() override {
+    m_plot_writer.Flush();
     m_plot_output.close();
     m_config_output.close();
   }
@@ -114,6 +209,11 @@ class StaticGnuplotHeatmapStorage : public SolutionStorageBase<MeshNodesType> {
   StringType m_config_file_name;
   std::ofstream m_config_output;
   std::ofstream m_plot_output;
+  LayerTextWriter<MeshNodesType> m_plot_writer{
+      m_plot_output, LayerTextWriter<MeshNodesType>::DefaultPrecision,
+      PlotNodeWidth};
+
+  static constexpr size_t PlotNodeWidth = 8;
 
   StringType plot_extension = ".plt";
   StringType config_extension = ".cfg";
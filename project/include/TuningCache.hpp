@@ -0,0 +1,44 @@
+#ifndef FINITEDIFFERENCEMETHOD_TUNINGCACHE_HPP_
+#define FINITEDIFFERENCEMETHOD_TUNINGCACHE_HPP_
+
+#include <map>
+#include <optional>
+#include <string>
+
+namespace fdm {
+namespace tune {
+/*
+ * Model name of the processor from /proc/cpuinfo, "unknown" if there
+ * is no such file or line. Tuned configuration is valid only for the
+ * processor, that it was measured on.
+ */
+std::string CpuModel();
+
+/**
+ * Persistent key-value storage for the tuned configurations. File is
+ * the plain text, one "key<TAB>value" entry per line, so it can be
+ * checked and edited by hand. Cache is only an optimization: missing
+ * or broken file is the empty cache, and if the file can't be written,
+ * the configuration is just tuned again on the next run.
+ */
+class TuningCache {
+ public:
+  using StringType = std::string;
+
+  explicit TuningCache(const StringType &file_name);
+
+  [[nodiscard]] std::optional<StringType> Find(const StringType &key) const;
+  // Add or replace the entry and rewrite the file
+  void Store(const StringType &key, const StringType &value);
+
+ private:
+  StringType m_file_name;
+  std::map<StringType, StringType> m_entries;
+
+  void Load();
+  void Save() const;
+};
+}  // namespace tune
+}  // namespace fdm
+
+#endif  // FINITEDIFFERENCEMETHOD_TUNINGCACHE_HPP_
@@ -0,0 +1,166 @@
+#include "CrossSection.hpp"
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fdm {
+namespace geometry {
+namespace {
+bool IsInHole(const std::vector<double> &values) {
+  size_t sign_counter = 0;
+  for (const double &item : values) {
+    if (item < 0) {
+      ++sign_counter;
+    }
+  }
+
+  return (sign_counter == 3 || sign_counter == 0);
+}
+}  // anonymous namespace
+
+CrossSection::CrossSection(const HoleGeometry &hole_geometry, double x_delta,
+                           double y_delta)
+    : m_hole_geometry(hole_geometry), m_x_delta(x_delta), m_y_delta(y_delta) {}
+
+void CrossSection::Classify(size_t rows, size_t cols,
+                            std::vector<NodeIndex> &hole_nodes,
+                            std::vector<BorderNode> &border_nodes) const {
+  std::vector<NodeRun> hole_runs;
+  Classify(rows, cols, hole_runs, border_nodes);
+  hole_nodes.clear();
+  for (const NodeRun &run : hole_runs) {
+    for (size_t i = run.col_begin; i < run.col_end; ++i) {
+      hole_nodes.push_back({run.row, i});
+    }
+  }
+}
+
+void CrossSection::Classify(size_t rows, size_t cols,
+                            std::vector<NodeRun> &hole_runs,
+                            std::vector<BorderNode> &border_nodes) const {
+  hole_runs.clear();
+  border_nodes.clear();
+  for (size_t j = 1; j + 1 < rows; ++j) {
+    for (size_t i = 1; i + 1 < cols; ++i) {
+      Point curr_point(static_cast<double>(i) * m_x_delta,
+                       static_cast<double>(j) * m_y_delta);
+      if (PointInHole(curr_point)) {
+        if (!hole_runs.empty() && hole_runs.back().row == j &&
+            hole_runs.back().col_end == i) {
+          ++hole_runs.back().col_end;
+        } else {
+          hole_runs.push_back({j, i, i + 1});
+        }
+      } else if (PointOnBorder(curr_point)) {
+        auto [has_inner, inner] = GetInnerNeighbor(i, j);
+        border_nodes.push_back({{j, i}, inner, has_inner});
+      }
+    }
+  }
+}
+
+std::tuple<double, double, double> CrossSection::CalcCheckValues(
+    Point point) const {
+  double check_val1 = (m_hole_geometry[0].x - point.x) *
+                          (m_hole_geometry[1].y - m_hole_geometry[0].y) -
+                      (m_hole_geometry[1].x - m_hole_geometry[0].x) *
+                          (m_hole_geometry[0].y - point.y);
+  double check_val2 = (m_hole_geometry[1].x - point.x) *
+                          (m_hole_geometry[2].y - m_hole_geometry[1].y) -
+                      (m_hole_geometry[2].x - m_hole_geometry[1].x) *
+                          (m_hole_geometry[1].y - point.y);
+  double check_val3 = (m_hole_geometry[2].x - point.x) *
+                          (m_hole_geometry[0].y - m_hole_geometry[2].y) -
+                      (m_hole_geometry[0].x - m_hole_geometry[2].x) *
+                          (m_hole_geometry[2].y - point.y);
+  return {check_val1, check_val2, check_val3};
+}
+
+std::pair<bool, NodeIndex> CrossSection::GetInnerNeighbor(
+    size_t x_shift, size_t y_shift) const {
+  auto cast_x_shift = static_cast<double>(x_shift);
+  auto cast_y_shift = static_cast<double>(y_shift);
+  Point up_neighbor((cast_x_shift + 1) * m_x_delta, cast_y_shift * m_y_delta);
+  Point down_neighbor((cast_x_shift - 1) * m_x_delta, cast_y_shift * m_y_delta);
+  Point right_neighbor(cast_x_shift * m_x_delta,
+                       (cast_y_shift - 1) * m_y_delta);
+  Point left_neighbor(cast_x_shift * m_x_delta, (cast_y_shift + 1) * m_y_delta);
+
+  if (!PointOnBorder(up_neighbor) && !PointInHole(up_neighbor)) {
+    return {true, {y_shift, x_shift + 1}};
+  }
+
+  if (!PointOnBorder(down_neighbor) && !PointInHole(down_neighbor)) {
+    return {true, {y_shift, x_shift - 1}};
+  }
+
+  if (!PointOnBorder(right_neighbor) && !PointInHole(right_neighbor)) {
+    return {true, {y_shift + 1, x_shift}};
+  }
+
+  if (!PointOnBorder(left_neighbor) && !PointInHole(left_neighbor)) {
+    return {true, {y_shift - 1, x_shift}};
+  }
+
+  return {false, {y_shift, x_shift}};
+}
+
+bool CrossSection::PointInHole(Point point) const {
+  /*
+   * Mathematical part - vector and pseudoscalar product.
+   * Implementation - products are considered (1,2,3 - triangle vertices, 0 -
+   * point):
+   * (x1-x0)*(y2-y1)-(x2-x1)*(y1-y0)
+   * (x2-x0)*(y3-y2)-(x3-x2)*(y2-y0)
+   * (x3-x0)*(y1-y3)-(x1-x3)*(y3-y0)
+   * If they are of the same sign, then the point is inside
+   * the triangle, otherwise the point is outside the triangle.
+   */
+  auto [check_val1, check_val2, check_val3] = CalcCheckValues(point);
+
+  // The comparison described above takes place in the function IsInHole
+  return IsInHole({check_val1, check_val2, check_val3});
+}
+
+bool CrossSection::PointOnBorder(Point point) const {
+  /*
+   * If one of bellow values is zero, then the point
+   * lies on the side
+   */
+
+  //   Check neighbor points
+  if (!PointInHole(point)) {
+    if (PointInHole(Point(point.x, point.y - m_y_delta))) {
+      return true;
+    }
+    if (PointInHole(Point(point.x, point.y + m_y_delta))) {
+      return true;
+    }
+    if (PointInHole(Point(point.x - m_x_delta, point.y))) {
+      return true;
+    }
+    if (PointInHole(Point(point.x + m_x_delta, point.y))) {
+      return true;
+    }
+
+    if (PointInHole(Point(point.x + m_x_delta, point.y - m_y_delta))) {
+      return true;
+    }
+    if (PointInHole(Point(point.x + m_x_delta, point.y + m_y_delta))) {
+      return true;
+    }
+    if (PointInHole(Point(point.x - m_x_delta, point.y - m_y_delta))) {
+      return true;
+    }
+    if (PointInHole(Point(point.x - m_x_delta, point.y + m_y_delta))) {
+      return true;
+    }
+  }
+
+  // The comparison described above takes place in the function IsInHole
+  return false;
+}
+
+}  // namespace geometry
+}  // namespace fdm
@@ -0,0 +1,181 @@
+#include "HeatmapStorage.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fdm {
+namespace solution {
+namespace image {
+namespace {
+std::array<uint32_t, 256> MakeCrcTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t n = 0; n < 256; ++n) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    table[n] = c;
+  }
+  return table;
+}
+
+uint32_t UpdateCrc(uint32_t crc, const uint8_t *data, size_t size) {
+  static const std::array<uint32_t, 256> table = MakeCrcTable();
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+uint32_t Adler32(const uint8_t *data, size_t size) {
+  // 5552 is the longest run, that can't overflow 32-bit sums
+  constexpr size_t MaxRun = 5552;
+  uint32_t a = 1;
+  uint32_t b = 0;
+  while (size != 0) {
+    size_t run = std::min(size, MaxRun);
+    size -= run;
+    for (size_t i = 0; i < run; ++i) {
+      a += data[i];
+      b += a;
+    }
+    data += run;
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+void PutBigEndian(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 24));
+  out.push_back(static_cast<uint8_t>(value >> 16));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutChunk(std::vector<uint8_t> &out, const char *type,
+              const std::vector<uint8_t> &data) {
+  PutBigEndian(out, static_cast<uint32_t>(data.size()));
+  size_t type_offset = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  uint32_t crc = UpdateCrc(0xFFFFFFFFu, out.data() + type_offset,
+                           data.size() + 4) ^
+                 0xFFFFFFFFu;
+  PutBigEndian(out, crc);
+}
+
+void WriteBytes(const std::string &file_name, const uint8_t *data,
+                size_t size) {
+  std::ofstream output(file_name, std::ios::binary);
+  if (!output.is_open()) {
+    throw exceptions::FileNotOpenException();
+  }
+  output.write(reinterpret_cast<const char *>(data),
+               static_cast<std::streamsize>(size));
+}
+}  // anonymous namespace
+
+Palette::Palette(const std::vector<Stop> &stops) {
+  for (size_t i = 0; i < TableSize; ++i) {
+    double t = static_cast<double>(i) / (TableSize - 1);
+    // Find the palette segment, that contains t
+    size_t upper = 1;
+    while (upper + 1 < stops.size() && stops[upper].position < t) {
+      ++upper;
+    }
+    const Stop &lo = stops[upper - 1];
+    const Stop &hi = stops[upper];
+    double span = hi.position - lo.position;
+    double w = span > 0.0 ? std::clamp((t - lo.position) / span, 0.0, 1.0)
+                          : 0.0;
+    auto channel = [w](double from, double to) {
+      return static_cast<uint8_t>((from + (to - from) * w) * 255.0 + 0.5);
+    };
+    m_table[i] = {channel(lo.r, hi.r), channel(lo.g, hi.g),
+                  channel(lo.b, hi.b)};
+  }
+}
+
+Palette Palette::GnuplotHeatmap() {
+  // set palette defined (0 0 0 0.5, 1 0 0 1, 2 0 0.5 1, 3 0 1 1,
+  //   4 0.5 1 0.5, 5 1 1 0, 6 1 0.5 0, 7 1 0 0, 8 0.5 0 0)
+  return Palette({{0.0 / 8, 0.0, 0.0, 0.5},
+                  {1.0 / 8, 0.0, 0.0, 1.0},
+                  {2.0 / 8, 0.0, 0.5, 1.0},
+                  {3.0 / 8, 0.0, 1.0, 1.0},
+                  {4.0 / 8, 0.5, 1.0, 0.5},
+                  {5.0 / 8, 1.0, 1.0, 0.0},
+                  {6.0 / 8, 1.0, 0.5, 0.0},
+                  {7.0 / 8, 1.0, 0.0, 0.0},
+                  {8.0 / 8, 0.5, 0.0, 0.0}});
+}
+
+void WritePpm(const std::string &file_name, const RgbImage &image) {
+  std::string header = "P6\n" + std::to_string(image.width) + ' ' +
+                       std::to_string(image.height) + "\n255\n";
+  std::vector<uint8_t> out(header.begin(), header.end());
+  out.insert(out.end(), image.pixels.begin(), image.pixels.end());
+  WriteBytes(file_name, out.data(), out.size());
+}
+
+void WritePng(const std::string &file_name, const RgbImage &image) {
+  constexpr size_t MaxStoredBlock = 65535;
+  const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> out(std::begin(signature), std::end(signature));
+
+  std::vector<uint8_t> header;
+  PutBigEndian(header, static_cast<uint32_t>(image.width));
+  PutBigEndian(header, static_cast<uint32_t>(image.height));
+  // 8 bit depth, truecolor, deflate, adaptive filtering, no interlace
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  PutChunk(out, "IHDR", header);
+
+  // Scanlines with "None" filter
+  size_t line_size = image.width * 3;
+  std::vector<uint8_t> raw;
+  raw.reserve((line_size + 1) * image.height);
+  for (size_t y = 0; y < image.height; ++y) {
+    raw.push_back(0);
+    const uint8_t *line = image.pixels.data() + y * line_size;
+    raw.insert(raw.end(), line, line + line_size);
+  }
+
+  // zlib stream of stored deflate blocks
+  std::vector<uint8_t> data{0x78, 0x01};
+  data.reserve(raw.size() + raw.size() / MaxStoredBlock * 5 + 16);
+  size_t offset = 0;
+  do {
+    size_t block = std::min(MaxStoredBlock, raw.size() - offset);
+    bool final_block = offset + block == raw.size();
+    data.push_back(final_block ? 1 : 0);
+    data.push_back(static_cast<uint8_t>(block));
+    data.push_back(static_cast<uint8_t>(block >> 8));
+    data.push_back(static_cast<uint8_t>(~block));
+    data.push_back(static_cast<uint8_t>(~block >> 8));
+    data.insert(data.end(), raw.begin() + static_cast<std::ptrdiff_t>(offset),
+                raw.begin() + static_cast<std::ptrdiff_t>(offset + block));
+    offset += block;
+  } while (offset < raw.size());
+  PutBigEndian(data, Adler32(raw.data(), raw.size()));
+  PutChunk(out, "IDAT", data);
+  PutChunk(out, "IEND", {});
+
+  WriteBytes(file_name, out.data(), out.size());
+}
+
+void WriteImage(const std::string &file_name, const RgbImage &image,
+                ImageFormat format) {
+  if (format == ImageFormat::Png) {
+    WritePng(file_name, image);
+  } else {
+    WritePpm(file_name, image);
+  }
+}
+}  // namespace image
+}  // namespace solution
+}  // namespace fdm
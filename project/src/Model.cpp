@@ -1,40 +1,85 @@
 #include "Model.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 
 #include "CalculationUtils.hpp"
+#include "TuningCache.hpp"
 
 namespace fdm {
 namespace {
-bool IsInHole(const std::vector<Model::ModelNodeType> &values) {
-  size_t sign_counter = 0;
-  for (const Model::ModelNodeType &item : values) {
-    if (item < 0) {
-      ++sign_counter;
-    }
+inline Model::ModelNodeType StencilUpdate(
+    Model::ModelNodeType center, Model::ModelNodeType left,
+    Model::ModelNodeType right, Model::ModelNodeType down,
+    Model::ModelNodeType up, Model::ModelNodeType face_left,
+    Model::ModelNodeType face_right, Model::ModelNodeType face_down,
+    Model::ModelNodeType face_up) {
+  return center + face_left * (left - center) + face_right * (right - center) +
+         face_down * (down - center) + face_up * (up - center);
+}
+
+/*
+ * Rows of the tiled storage are contiguous only inside the tile, so
+ * active tiles and row segments can't cross storage tiles.
+ */
+template <typename MeshType>
+size_t ContiguousSide(size_t tile_size) {
+  if constexpr (requires { MeshType::TileSide; }) {
+    return MeshType::TileSide;
+  } else {
+    return tile_size;
   }
+}
 
-  return (sign_counter == 3 || sign_counter == 0);
+// Diffusivity of the face between two materials is the harmonic mean:
+// that is what keeps heat flux continuous on the interface.
+double FaceDiffusivity(double lhs, double rhs) {
+  return lhs == rhs ? lhs : (lhs + rhs > 0.0 ? 2 * lhs * rhs / (lhs + rhs)
+                                             : 0.0);
+}
+
+// Index of the worker, that ParallelRows gave the nonempty block begin
+size_t WorkerIndex(size_t rows, size_t workers, size_t begin) {
+  size_t worker = 0;
+  while (mtrx::alloc::WorkerRows(rows, workers, worker).first != begin) {
+    ++worker;
+  }
+  return worker;
 }
 }  // anonymous namespace
 
 Model::Model(double width, double height, double delta_n, double time_delta)
-    : m_mesh_ptr_present(MatrixBuilder().Build<ModelNodeType>()),
-      m_mesh_ptr_last(MatrixBuilder().Build<ModelNodeType>()),
+    : m_mesh_ptr_present(MatrixBuilder().BuildTarget<ModelNodeType>()),
+      m_mesh_ptr_last(MatrixBuilder().BuildTarget<ModelNodeType>()),
       m_width(width),
       m_height(height),
       m_x_delta(delta_n),
       m_y_delta(delta_n),
-      m_time_delta(time_delta) {
+      m_time_delta(time_delta),
+      m_workers(1),
+      m_diffusivity([](Point) { return DefDiffusivity; }),
+      m_face_x(MatrixBuilder().BuildTarget<ModelNodeType>()),
+      m_face_y(MatrixBuilder().BuildTarget<ModelNodeType>()) {
   if ((m_time_delta / m_x_delta) * (m_time_delta / m_x_delta) > 0.5) {
     throw exceptions::WrongDeltaRel();
   }
   m_nodes_x = static_cast<size_t>(m_width / m_x_delta);
   m_nodes_y = static_cast<size_t>(m_height / m_y_delta);
+  // Last layer is allocated by the first two-layer step, in-place mode
+  // never needs it
   m_mesh_ptr_present->SetSize(m_nodes_y, m_nodes_x);
-  m_mesh_ptr_last->SetSize(m_nodes_y, m_nodes_x);
 
   m_hole_geometry[0] = Point();
   m_hole_geometry[1] = Point();
@@ -45,11 +90,107 @@ void Model::SetHoleGeometry(Point p1, Point p2, Point p3) {
   m_hole_geometry[0] = p1;
   m_hole_geometry[1] = p2;
   m_hole_geometry[2] = p3;
+  m_stencil_ready = false;
+}
+
+void Model::SetSpatialOrder(SpatialOrder order) {
+  m_spatial_order = order;
+  m_stencil_ready = false;
+}
+
+void Model::SetIncremental(double epsilon, size_t tile_size) {
+  m_incremental_epsilon = epsilon;
+  m_active_tile_size = std::max<size_t>(tile_size, 1);
+  m_incremental_stats = IncrementalStats();
+  PrepareActiveTiles();
+}
+
+void Model::SetDiffusivity(double diffusivity) {
+  m_diffusivity = [diffusivity](Point) { return diffusivity; };
+  m_stencil_ready = false;
+}
+
+void Model::SetDiffusivity(const DiffusivityFieldType &diffusivity) {
+  m_diffusivity = diffusivity;
+  m_stencil_ready = false;
+}
+
+void Model::SetWorkers(size_t workers) {
+  m_workers = std::max<size_t>(workers, 1);
+  m_mesh_ptr_present->SetWorkers(m_workers);
+  m_mesh_ptr_last->SetWorkers(m_workers);
+  m_face_x->SetWorkers(m_workers);
+  m_face_y->SetWorkers(m_workers);
+  m_stencil_ready = false;
+}
+
+void Model::SetAutotune(const std::string &cache_file) {
+  m_tuning_cache_file = cache_file;
+  m_tuned_key.clear();
+  if (cache_file.empty()) {
+    SwitchInPlace(m_in_place_requested);
+  }
+}
+
+void Model::SetReductions(const ReductionRequest &request) {
+  m_reduction_request = request;
+  m_reductions.clear();
+  m_reduction_time = 0.0;
+}
+
+void Model::SetTimeScheme(TimeScheme scheme, size_t stages) {
+  m_time_scheme = scheme;
+  m_stages = std::max<size_t>(stages, 1);
 }
 
 void Model::SetInitialCondition(ModelNodeType init_conditions) {
   m_mesh_ptr_present->FillMatrix(init_conditions);
-  m_mesh_ptr_last->FillMatrix(init_conditions);
+  if (m_mesh_ptr_last->SizeRows() != 0) {
+    m_mesh_ptr_last->FillMatrix(init_conditions);
+  }
+}
+
+void Model::SetInitialCondition(const TemperatureFieldType &init_conditions) {
+  auto &present = *m_mesh_ptr_present;
+  for (size_t j = 0; j < present.SizeRows(); ++j) {
+    for (size_t i = 0; i < present.SizeCols(); ++i) {
+      present.At(j, i) =
+          init_conditions(Point(static_cast<double>(i) * m_x_delta,
+                                static_cast<double>(j) * m_y_delta));
+      // Last layer could be not allocated yet
+      if (m_mesh_ptr_last->SizeRows() != 0) {
+        m_mesh_ptr_last->At(j, i) = present.At(j, i);
+      }
+    }
+  }
+}
+
+void Model::SetInPlace(bool in_place) {
+  m_in_place_requested = in_place;
+  SwitchInPlace(in_place);
+}
+
+void Model::SwitchInPlace(bool in_place) {
+  auto &present = *m_mesh_ptr_present;
+  size_t rows = present.SizeRows();
+  size_t cols = present.SizeCols();
+  if (in_place) {
+    if (m_mesh_ptr_last->SizeRows() != 0) {
+      m_mesh_ptr_last->SetSize(0, 0);
+    }
+  } else if (m_mesh_ptr_last->SizeRows() != rows) {
+    // Last layer starts as the copy of the present one
+    m_mesh_ptr_last->SetSize(rows, cols);
+    for (size_t j = 0; j < rows; ++j) {
+      for (size_t i = 0; i < cols; ++i) {
+        m_mesh_ptr_last->At(j, i) = present.At(j, i);
+      }
+    }
+  }
+  if (in_place != m_in_place) {
+    m_in_place = in_place;
+    m_stencil_ready = false;
+  }
 }
 
 void Model::SetOuterRestrictions(
@@ -75,55 +216,325 @@ void Model::SetInnerRestrictions(
 void Model::TimeIntegrate(double total_time,
                           solution::SolutionStorageBase<ModelNodeType> &storage,
                           ModelNodeType tube_flow) {
+  // Autotuning chooses in-place mode only where it is supported
+  if (m_in_place_requested && (m_spatial_order != SpatialOrder::Second ||
+                               m_incremental_epsilon > 0.0)) {
+    throw exceptions::InPlaceUnsupported();
+  }
+  if (m_time_scheme == TimeScheme::SuperTimeStepping &&
+      (m_spatial_order != SpatialOrder::Second || m_in_place_requested ||
+       m_incremental_epsilon > 0.0)) {
+    throw exceptions::TimeSchemeUnsupported();
+  }
+  if (!m_tuning_cache_file.empty()) {
+    Autotune(tube_flow);
+  }
+  // Allocates the last layer, if the two-layer step needs it
+  SwitchInPlace(m_in_place);
+  if (!m_stencil_ready) {
+    PrepareStencil();
+  }
   storage.CommitLayer(m_mesh_ptr_present);
 
+  if (m_time_scheme == TimeScheme::SuperTimeStepping) {
+    IntegrateSuperSteps(total_time, storage, tube_flow);
+    return;
+  }
+
   auto time_integrate_iterations =
       static_cast<size_t>(total_time / m_time_delta);
 
+  if (m_incremental_epsilon > 0.0) {
+    // Nothing is known about the initial layer, so everything is active
+    std::fill(m_tile_changed.begin(), m_tile_changed.end(), 1);
+    std::fill(m_tile_synced.begin(), m_tile_synced.end(), 0);
+  }
+
   // Iterate time layers
   for (size_t t = 0; t < time_integrate_iterations; ++t) {
-    m_mesh_ptr_last = m_mesh_ptr_present;
-    ComputeBoundaries();
+    ComputeLayer(tube_flow);
+    EmitReductions(m_time_delta);
+    storage.CommitLayer(m_mesh_ptr_present);
+  }
+  storage.CommitLayer(m_mesh_ptr_present);
+}
 
-    ComputePlate(tube_flow);
+void Model::ComputeLayer(ModelNodeType tube_flow) {
+  // Present layer becomes the last one, and the old last layer
+  // storage is reused for the new present layer. In-place mode
+  // overwrites the only layer.
+  //
+  // So every node reads the last layer only, it is the textbook explicit
+  // scheme. Results differ from the report, see README.
+  if (!m_in_place) {
+    std::swap(m_mesh_ptr_last, m_mesh_ptr_present);
+  }
+  BeginLayerReductions(true);
+  ComputePlate(tube_flow);
+
+  // Boundaries depend on just computed inner nodes
+  ComputeBoundaries();
+  if (m_incremental_epsilon > 0.0) {
+    UpdateActiveTiles();
+  }
+}
 
+void Model::Autotune(ModelNodeType tube_flow) {
+  std::string key = TuningKey();
+  if (key == m_tuned_key) {
+    return;
+  }
+  tune::TuningCache cache(m_tuning_cache_file);
+  TuningConfig config;
+  std::optional<std::string> cached = cache.Find(key);
+  if (cached && ParseTuningConfig(*cached, config)) {
+    ApplyTuningConfig(config);
+  } else {
+    config = MeasureTuningConfigs(tube_flow);
+    std::ostringstream value;
+    value << config.workers << ' ' << config.in_place;
+    cache.Store(key, value.str());
+  }
+  m_tuned_key = key;
+}
+
+std::string Model::TuningKey() const {
+  // Everything, that changes the candidates or their relative speed
+  std::ostringstream key;
+  key << tune::CpuModel() << " | " << m_mesh_ptr_present->SizeRows() << 'x'
+      << m_mesh_ptr_present->SizeCols() << " | order "
+      << (m_spatial_order == SpatialOrder::Second ? 2 : 4) << ", stages "
+      << (m_time_scheme == TimeScheme::Explicit ? 0 : m_stages)
+      << ", incremental " << (m_incremental_epsilon > 0.0) << ", in-place "
+      << m_in_place_requested;
+  return key.str();
+}
+
+bool Model::ParseTuningConfig(const std::string &value,
+                              TuningConfig &config) const {
+  std::istringstream stream(value);
+  size_t workers = 0;
+  bool in_place = false;
+  if (!(stream >> workers >> in_place)) {
+    return false;
+  }
+  // Cache is edited by hand too, so only the configurations, that
+  // MeasureTuningConfigs could choose, are accepted
+  size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  if (workers == 0 || workers > hardware) {
+    return false;
+  }
+  if (in_place != m_in_place_requested && !(in_place && InPlaceTunable())) {
+    return false;
+  }
+  config.workers = workers;
+  config.in_place = in_place;
+  return true;
+}
+
+bool Model::InPlaceTunable() const {
+  return m_spatial_order == SpatialOrder::Second &&
+         m_time_scheme == TimeScheme::Explicit && m_incremental_epsilon <= 0.0;
+}
+
+Model::LayerSnapshot Model::SaveLayers() {
+  // Two layers are the complete state, in-place mode can be restored
+  // from them
+  SwitchInPlace(false);
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
+  LayerSnapshot snapshot;
+  snapshot.present.resize(rows * cols);
+  snapshot.last.resize(rows * cols);
+  for (size_t j = 0; j < rows; ++j) {
+    m_mesh_ptr_present->CopyRow(j, snapshot.present.data() + j * cols);
+    m_mesh_ptr_last->CopyRow(j, snapshot.last.data() + j * cols);
+  }
+  snapshot.incremental_stats = m_incremental_stats;
+  return snapshot;
+}
+
+void Model::RestoreLayers(const LayerSnapshot &snapshot,
+                          const TuningConfig &config) {
+  // Changing the amount of workers places the mesh again
+  SwitchInPlace(false);
+  SetWorkers(config.workers);
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
+  for (size_t j = 0; j < rows; ++j) {
+    for (size_t i = 0; i < cols; ++i) {
+      m_mesh_ptr_present->At(j, i) = snapshot.present[j * cols + i];
+      m_mesh_ptr_last->At(j, i) = snapshot.last[j * cols + i];
+    }
+  }
+  SwitchInPlace(config.in_place);
+  m_incremental_stats = snapshot.incremental_stats;
+}
+
+void Model::ApplyTuningConfig(const TuningConfig &config) {
+  // Mesh values are kept by SetWorkers, so no snapshot is needed. The
+  // last layer is dropped before the mesh is placed again, or allocated
+  // after it, with the new workers.
+  if (config.in_place) {
+    SwitchInPlace(true);
+    SetWorkers(config.workers);
+  } else {
+    SetWorkers(config.workers);
+    SwitchInPlace(false);
+  }
+}
+
+Model::TuningConfig Model::MeasureTuningConfigs(ModelNodeType tube_flow) {
+  // Candidates give the same results, they differ in speed only
+  std::vector<size_t> workers;
+  size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  for (size_t count = 1; count < hardware; count *= 2) {
+    workers.push_back(count);
+  }
+  workers.push_back(hardware);
+  // In-place mode could be requested to save memory, it is kept then
+  std::vector<bool> in_place = {m_in_place_requested};
+  if (!m_in_place_requested && InPlaceTunable()) {
+    in_place.push_back(true);
+  }
+
+  LayerSnapshot snapshot = SaveLayers();
+  TuningConfig best;
+  double best_seconds = std::numeric_limits<double>::infinity();
+  for (size_t count : workers) {
+    for (bool candidate_in_place : in_place) {
+      TuningConfig candidate{count, candidate_in_place};
+      RestoreLayers(snapshot, candidate);
+      PrepareStencil();
+      double seconds = MeasureLayer(tube_flow);
+      if (seconds < best_seconds) {
+        best_seconds = seconds;
+        best = candidate;
+      }
+    }
+  }
+  RestoreLayers(snapshot, best);
+  return best;
+}
+
+double Model::MeasureLayer(ModelNodeType tube_flow) {
+  size_t super_step = m_stages * (m_stages + 1) / 2;
+  auto layer = [&]() {
+    if (m_time_scheme == TimeScheme::SuperTimeStepping) {
+      ComputeSuperStep(m_stages, super_step, tube_flow);
+    } else {
+      ComputeLayer(tube_flow);
+    }
+  };
+
+  // The first layer warms caches up and places the memory
+  layer();
+  using Clock = std::chrono::steady_clock;
+  size_t layers = 0;
+  double seconds = 0.0;
+  auto start = Clock::now();
+  while (layers < TuneMaxLayers &&
+         (layers < TuneMinLayers || seconds < TuneSeconds)) {
+    layer();
+    ++layers;
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return seconds / static_cast<double>(layers);
+}
+
+void Model::IntegrateSuperSteps(
+    double total_time, solution::SolutionStorageBase<ModelNodeType> &storage,
+    ModelNodeType tube_flow) {
+  // Same final time as the explicit scheme. The last step is shorter,
+  // if the explicit steps don't fill whole super steps.
+  auto explicit_steps = static_cast<size_t>(total_time / m_time_delta);
+  size_t super_step = m_stages * (m_stages + 1) / 2;
+  while (explicit_steps > 0) {
+    size_t step = std::min(explicit_steps, super_step);
+    size_t stages = 1;
+    while (stages * (stages + 1) / 2 < step) {
+      ++stages;
+    }
+    ComputeSuperStep(stages, step, tube_flow);
+    EmitReductions(static_cast<double>(step) * m_time_delta);
+    explicit_steps -= step;
     storage.CommitLayer(m_mesh_ptr_present);
   }
   storage.CommitLayer(m_mesh_ptr_present);
 }
 
+void Model::ComputeSuperStep(size_t stages, size_t explicit_steps,
+                             ModelNodeType tube_flow) {
+  /*
+   * RKL1 with the step tau = explicit_steps * dt <= dt * s (s + 1) / 2:
+   * Y_0 = T, Y_j = mu_j Y_{j-1} + nu_j Y_{j-2} + mu~_j tau L Y_{j-1},
+   * mu_j = (2j - 1) / j, nu_j = (1 - j) / j,
+   * mu~_j = mu_j * 2 / (s (s + 1)).
+   * dt L Y is E(Y) - Y, where E is the explicit step, so stage is the
+   * usual sweep. Y_j only reads Y_{j-2} in the same node, so it
+   * overwrites Y_{j-2}, and two layers are enough.
+   */
+  size_t norm = stages * (stages + 1);
+  for (size_t j = 1; j <= stages; ++j) {
+    m_stage.mu = static_cast<double>(2 * j - 1) / static_cast<double>(j);
+    m_stage.nu = -static_cast<double>(j - 1) / static_cast<double>(j);
+    m_stage.weight = static_cast<double>(2 * (2 * j - 1) * explicit_steps) /
+                     static_cast<double>(j * norm);
+    // First stage of the full super step is exactly the explicit step
+    m_stage.plain = j == 1 && m_stage.weight == 1.0;
+
+    std::swap(m_mesh_ptr_last, m_mesh_ptr_present);
+    // Only the last stage is the layer
+    BeginLayerReductions(j == stages);
+    ComputePlate(tube_flow);
+    ComputeBoundaries();
+  }
+  m_stage = StageCoefficients();
+}
+
 void Model::ComputeBoundaries() {
   // Traverse all boundary nodes necessary
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
 
   // Firstly perform left and right boundaries
-  for (size_t i = 1; i < m_mesh_ptr_last->SizeRows() - 1; ++i) {
+  for (size_t i = 1; i < m_mesh_ptr_present->SizeRows() - 1; ++i) {
     ModelNodeType T_x_left_inner = m_mesh_ptr_present->GetValue(i, 1);
     ModelNodeType T_x_right_inner =
-        m_mesh_ptr_present->GetValue(i, m_mesh_ptr_last->SizeCols() - 2);
+        m_mesh_ptr_present->GetValue(i, m_mesh_ptr_present->SizeCols() - 2);
 
     m_mesh_ptr_present->SetValue(
         i, 0,
         m_outer_restrictions[restr::LEFT_RESTRICTION]->operator()(
             T_x_left_inner, m_y_delta));
     m_mesh_ptr_present->SetValue(
-        i, m_mesh_ptr_last->SizeCols() - 1,
+        i, m_mesh_ptr_present->SizeCols() - 1,
         m_outer_restrictions[restr::RIGHT_RESTRICTION]->operator()(
             T_x_right_inner, m_y_delta));
+    if (m_reduce_temperature) {
+      m_layer_partial.Add(m_mesh_ptr_present->GetValue(i, 0));
+      m_layer_partial.Add(m_mesh_ptr_present->GetValue(i, cols - 1));
+    }
   }
 
-  // Finally, perform up and down boundaries
-  for (size_t i = 0; i < m_mesh_ptr_last->SizeCols(); ++i) {
+  // Finally, perform up and down boundaries. As the other edges, they
+  // depend on the nearest inner row of the layer just computed.
+  for (size_t i = 0; i < m_mesh_ptr_present->SizeCols(); ++i) {
     ModelNodeType T_x_down_inner = m_mesh_ptr_present->GetValue(1, i);
     ModelNodeType T_x_up_inner =
-        m_mesh_ptr_present->GetValue(m_mesh_ptr_last->SizeRows() - 1, i);
+        m_mesh_ptr_present->GetValue(m_mesh_ptr_present->SizeRows() - 2, i);
     m_mesh_ptr_present->SetValue(
         0, i,
         m_outer_restrictions[restr::DOWN_RESTRICTION]->operator()(
             T_x_down_inner, m_x_delta));
     m_mesh_ptr_present->SetValue(
-        m_mesh_ptr_last->SizeRows() - 1, i,
+        m_mesh_ptr_present->SizeRows() - 1, i,
         m_outer_restrictions[restr::UP_RESTRICTION]->operator()(T_x_up_inner,
                                                                 m_x_delta));
+    if (m_reduce_temperature) {
+      m_layer_partial.Add(m_mesh_ptr_present->GetValue(0, i));
+      m_layer_partial.Add(m_mesh_ptr_present->GetValue(rows - 1, i));
+    }
   }
 
   // In fact there is no necessary dependencies for mesh boundary traversal.
@@ -131,136 +542,695 @@ void Model::ComputeBoundaries() {
 }
 
 void Model::ComputePlate(ModelNodeType tube_flow) {
-  for (size_t j = 1; j < m_mesh_ptr_last->SizeRows() - 1; ++j) {
-    for (size_t i = 1; i < m_mesh_ptr_last->SizeCols() - 1; ++i) {
-      Point curr_point(static_cast<double>(i) * m_x_delta,
-                       static_cast<double>(j) * m_y_delta);
-      if (!PointInHole(curr_point)) {
-        if (PointOnBorder(curr_point)) {
-          ModelNodeType inner_value = GetInnerNeighbor(i, j);
-          m_mesh_ptr_present->SetValue(
-              j, i, m_inner_restriction->operator()(inner_value, m_x_delta));
-        } else {
-          equations::HeatConductionParamsType<ModelNodeType>
-              equation_parameters{m_mesh_ptr_last->GetValue(j, i),
-                                  m_mesh_ptr_last->GetValue(j, i - 1),
-                                  m_mesh_ptr_last->GetValue(j, i + 1),
-                                  m_mesh_ptr_last->GetValue(j - 1, i),
-                                  m_mesh_ptr_last->GetValue(j + 1, i),
-                                  m_time_delta,
-                                  m_x_delta,
-                                  m_y_delta,
-                                  0.1};
-          m_mesh_ptr_present->SetValue(
-              j, i, equations::HeatConductionProblem(equation_parameters));
-        }
-      } else {
-        m_mesh_ptr_present->SetValue(j, i,
-                                     std::forward<ModelNodeType>(tube_flow));
+  // Border nodes need old values, save them before the sweep
+  const auto &old_layer = m_in_place ? *m_mesh_ptr_present : *m_mesh_ptr_last;
+  m_border_inner.resize(m_border_nodes.size());
+  for (size_t n = 0; n < m_border_nodes.size(); ++n) {
+    const BorderNode &border = m_border_nodes[n];
+    m_border_inner[n] =
+        border.has_inner ? old_layer.At(border.inner.row, border.inner.col)
+                         : 0.0;
+  }
+
+  // Every worker reduces the nodes it has just computed into its own
+  // partial, partials are merged after the sweep
+  m_worker_partials.assign(m_workers, ReductionPartial());
+  if (m_in_place) {
+    ComputePlateInPlace();
+  } else if (m_incremental_epsilon > 0.0) {
+    ComputeActiveTiles();
+  } else {
+    const auto &mesh = *m_mesh_ptr_last;
+    // Each worker computes the same tiles it has touched first
+    mtrx::alloc::ParallelRows(
+        mesh.TileCount(), m_workers, [&](size_t begin, size_t end) {
+          if (begin == end) {
+            return;
+          }
+          ReductionPartial &partial =
+              m_worker_partials[WorkerIndex(mesh.TileCount(), m_workers,
+                                            begin)];
+          for (size_t t = begin; t < end; ++t) {
+            mtrx::Tile tile = mesh.GetTile(t);
+            if (m_stage.plain) {
+              ComputePlateTile(tile);
+            } else {
+              ComputeStageTile(tile);
+            }
+            if (m_reduce_temperature) {
+              AccumulatePlate(tile, partial);
+            }
+          }
+        });
+  }
+  for (const ReductionPartial &partial : m_worker_partials) {
+    m_layer_partial.Merge(partial);
+  }
+
+  // Hole and its border are not described by the stencil
+  auto &present = *m_mesh_ptr_present;
+  for (const NodeRun &run : m_hole_runs) {
+    for (size_t i = run.col_begin; i < run.col_end; ++i) {
+      present.At(run.row, i) = tube_flow;
+    }
+  }
+  for (size_t n = 0; n < m_border_nodes.size(); ++n) {
+    const NodeIndex &node = m_border_nodes[n].node;
+    ModelNodeType value =
+        m_inner_restriction->operator()(m_border_inner[n], m_x_delta);
+    present.At(node.row, node.col) = value;
+    if (m_reduce_temperature) {
+      m_layer_partial.Add(value);
+    }
+  }
+
+  /*
+   * Flux through the border element of length d is a * dT / dn * d, and
+   * the normal derivative is taken towards the inner neighbor, so the
+   * element gives a * (T_inner - T_border) regardless of d.
+   */
+  if (m_reduce_hole_flux) {
+    for (size_t n = 0; n < m_border_nodes.size(); ++n) {
+      const BorderNode &border = m_border_nodes[n];
+      if (border.has_inner) {
+        m_layer_hole_flux +=
+            m_border_diffusivity[n] *
+            (present.At(border.inner.row, border.inner.col) -
+             present.At(border.node.row, border.node.col));
       }
     }
   }
 }
 
-std::tuple<Model::ModelNodeType, Model::ModelNodeType, Model::ModelNodeType>
-Model::CalcCheckValues(Point point) const {
-  ModelNodeType check_val1 = (m_hole_geometry[0].x - point.x) *
-                                 (m_hole_geometry[1].y - m_hole_geometry[0].y) -
-                             (m_hole_geometry[1].x - m_hole_geometry[0].x) *
-                                 (m_hole_geometry[0].y - point.y);
-  ModelNodeType check_val2 = (m_hole_geometry[1].x - point.x) *
-                                 (m_hole_geometry[2].y - m_hole_geometry[1].y) -
-                             (m_hole_geometry[2].x - m_hole_geometry[1].x) *
-                                 (m_hole_geometry[1].y - point.y);
-  ModelNodeType check_val3 = (m_hole_geometry[2].x - point.x) *
-                                 (m_hole_geometry[0].y - m_hole_geometry[2].y) -
-                             (m_hole_geometry[0].x - m_hole_geometry[2].x) *
-                                 (m_hole_geometry[2].y - point.y);
-  return {check_val1, check_val2, check_val3};
+void Model::AccumulatePlate(const mtrx::Tile &tile,
+                            ReductionPartial &partial) const {
+  const auto &present = *m_mesh_ptr_present;
+  size_t segment =
+      ContiguousSide<MatrixBuilder::TargetType<ModelNodeType>>(
+          present.SizeCols());
+  size_t row_begin = std::max<size_t>(tile.row_begin, 1);
+  size_t row_end = std::min(tile.row_end, present.SizeRows() - 1);
+  for (size_t j = row_begin; j < row_end; ++j) {
+    for (size_t r = m_plate_row_runs[j]; r < m_plate_row_runs[j + 1]; ++r) {
+      size_t col_begin = std::max(m_plate_runs[r].col_begin, tile.col_begin);
+      size_t col_end = std::min(m_plate_runs[r].col_end, tile.col_end);
+      // Walk contiguous segments of the run
+      for (size_t col = col_begin; col < col_end;) {
+        size_t next = std::min(col_end, (col / segment + 1) * segment);
+        partial.AddRange(&present.At(j, col), next - col);
+        col = next;
+      }
+    }
+  }
 }
 
-Model::ModelNodeType Model::GetInnerNeighbor(size_t x_shift, size_t y_shift) {
-  auto cast_x_shift = static_cast<double>(x_shift);
-  auto cast_y_shift = static_cast<double>(y_shift);
-  Point up_neighbor((cast_x_shift + 1) * m_x_delta, cast_y_shift * m_y_delta);
-  Point down_neighbor((cast_x_shift - 1) * m_x_delta, cast_y_shift * m_y_delta);
-  Point right_neighbor(cast_x_shift * m_x_delta,
-                       (cast_y_shift - 1) * m_y_delta);
-  Point left_neighbor(cast_x_shift * m_x_delta, (cast_y_shift + 1) * m_y_delta);
+void Model::BeginLayerReductions(bool reduce) {
+  m_reduce_temperature = reduce && m_reduction_request.temperature;
+  m_reduce_hole_flux = reduce && m_reduction_request.hole_flux;
+  m_layer_partial = ReductionPartial();
+  m_layer_hole_flux = 0.0;
+}
 
-  if (!PointOnBorder(up_neighbor) && !PointInHole(up_neighbor)) {
-    return m_mesh_ptr_last->GetValue(y_shift, x_shift + 1);
+void Model::EmitReductions(double time_step) {
+  m_reduction_time += time_step;
+  if (!m_reduction_request.temperature && !m_reduction_request.hole_flux) {
+    return;
+  }
+  LayerReductions layer;
+  layer.time = m_reduction_time;
+  if (m_reduction_request.temperature) {
+    layer.min = m_layer_partial.min;
+    layer.max = m_layer_partial.max;
+    layer.mean = m_layer_partial.sum / static_cast<double>(m_plate_nodes);
   }
+  layer.hole_flux = m_layer_hole_flux;
+  m_reductions.push_back(layer);
+}
+
+void Model::ComputePlateInPlace() {
+  auto &mesh = *m_mesh_ptr_present;
+  size_t rows = mesh.SizeRows();
+  size_t cols = mesh.SizeCols();
+  size_t inner_rows = rows - 2;
 
-  if (!PointOnBorder(down_neighbor) && !PointInHole(down_neighbor)) {
-    return m_mesh_ptr_last->GetValue(y_shift, x_shift - 1);
+  /*
+   * Worker w owns inner rows [begin + 1, end + 1) and keeps old rows in
+   * its ring: row j lives in the slot j % 3 until the row j + 2 needs
+   * the slot. Neighbor bands are overwritten concurrently, so the rows
+   * around the band are saved before anybody starts: the row before the
+   * band goes to the ring, the row after it goes to the extra slot.
+   */
+  m_saved_rows.resize(m_workers * SavedRowsPerWorker * cols);
+  auto ring = [&](size_t worker, size_t row) {
+    return m_saved_rows.data() +
+           (worker * SavedRowsPerWorker + row % (SavedRowsPerWorker - 1)) *
+               cols;
+  };
+  auto after_band = [&](size_t worker) {
+    return m_saved_rows.data() +
+           (worker * SavedRowsPerWorker + SavedRowsPerWorker - 1) * cols;
+  };
+  for (size_t w = 0; w < m_workers; ++w) {
+    auto [begin, end] = mtrx::alloc::WorkerRows(inner_rows, m_workers, w);
+    if (begin < end) {
+      mesh.CopyRow(begin, ring(w, begin));
+      mesh.CopyRow(end + 1, after_band(w));
+    }
   }
 
-  if (!PointOnBorder(right_neighbor) && !PointInHole(right_neighbor)) {
-    return m_mesh_ptr_last->GetValue(y_shift + 1, x_shift);
+  mtrx::alloc::ParallelRows(
+      inner_rows, m_workers, [&](size_t begin, size_t end) {
+        if (begin == end) {
+          return;
+        }
+        size_t worker = WorkerIndex(inner_rows, m_workers, begin);
+        ReductionPartial &partial = m_worker_partials[worker];
+        mesh.CopyRow(begin + 1, ring(worker, begin + 1));
+        for (size_t j = begin + 1; j <= end; ++j) {
+          const ModelNodeType *up = after_band(worker);
+          if (j < end) {
+            up = ring(worker, j + 1);
+            mesh.CopyRow(j + 1, ring(worker, j + 1));
+          }
+          ComputeRowInPlace(j, ring(worker, j - 1), ring(worker, j), up);
+          if (m_reduce_temperature) {
+            AccumulatePlate({j, j + 1, 0, cols}, partial);
+          }
+        }
+      });
+}
+
+Model::FaceRow Model::GetFaceRow(size_t row, size_t col) const {
+  if (m_uniform_stencil) {
+    const ModelNodeType *fx = m_uniform_face_x.data() + col;
+    const ModelNodeType *fy = m_uniform_face_y.data() + col;
+    return {fx, fy, fy, fx[-1]};
+  }
+  return {&m_face_x->At(row, col), &m_face_y->At(row - 1, col),
+          &m_face_y->At(row, col), m_face_x->At(row, col - 1)};
+}
+
+void Model::ComputeRowInPlace(size_t row, const ModelNodeType *down,
+                              const ModelNodeType *center,
+                              const ModelNodeType *up) {
+  auto &mesh = *m_mesh_ptr_present;
+  size_t cols = mesh.SizeCols();
+  size_t segment =
+      ContiguousSide<MatrixBuilder::TargetType<ModelNodeType>>(cols);
+
+  // Old rows are whole, only the result and face weights are segmented
+  for (size_t col = 0; col < cols; col += segment) {
+    size_t col_begin = std::max<size_t>(col, 1);
+    size_t col_end = std::min(col + segment, cols - 1);
+    if (col_begin >= col_end) {
+      continue;
+    }
+    auto [fx, fy_down, fy_up, face_left_edge] = GetFaceRow(row, col_begin);
+    ModelNodeType *result = &mesh.At(row, col_begin);
+
+    size_t i = col_begin;
+    result[0] = StencilUpdate(center[i], center[i - 1], center[i + 1],
+                              down[i], up[i], face_left_edge, fx[0],
+                              fy_down[0], fy_up[0]);
+    for (size_t k = 1; k < col_end - col_begin; ++k) {
+      i = col_begin + k;
+      result[k] = StencilUpdate(center[i], center[i - 1], center[i + 1],
+                                down[i], up[i], fx[k - 1], fx[k], fy_down[k],
+                                fy_up[k]);
+    }
   }
+}
+
+template <typename Combine>
+void Model::ComputePlateTile(const mtrx::Tile &tile, Combine combine) {
+  const auto &last = *m_mesh_ptr_last;
+  auto &present = *m_mesh_ptr_present;
 
-  if (!PointOnBorder(left_neighbor) && !PointInHole(left_neighbor)) {
-    return m_mesh_ptr_last->GetValue(y_shift - 1, x_shift);
+  // Outer boundary nodes are computed separately
+  size_t row_begin = std::max<size_t>(tile.row_begin, 1);
+  size_t row_end = std::min(tile.row_end, last.SizeRows() - 1);
+  size_t col_begin = std::max<size_t>(tile.col_begin, 1);
+  size_t col_end = std::min(tile.col_end, last.SizeCols() - 1);
+  if (col_begin >= col_end) {
+    return;
   }
 
-  return 0.0;
+  // Second order update of the row segment [begin, end) of the tile.
+  // Row segments of the tile are contiguous (see mtrx::Tile), only the
+  // segment ends need the neighbors from other tiles.
+  auto second_order = [&](size_t j, size_t begin, size_t end) {
+    const ModelNodeType *down = &last.At(j - 1, begin);
+    const ModelNodeType *center = &last.At(j, begin);
+    const ModelNodeType *up = &last.At(j + 1, begin);
+    auto [fx, fy_down, fy_up, face_left_edge] = GetFaceRow(j, begin);
+    ModelNodeType *result = &present.At(j, begin);
+
+    ModelNodeType left_edge = last.At(j, begin - 1);
+    ModelNodeType right_edge = last.At(j, end);
+    size_t last_k = end - begin - 1;
+    if (last_k == 0) {
+      result[0] = combine(
+          StencilUpdate(center[0], left_edge, right_edge, down[0], up[0],
+                        face_left_edge, fx[0], fy_down[0], fy_up[0]),
+          center[0], result[0]);
+      return;
+    }
+
+    result[0] = combine(
+        StencilUpdate(center[0], left_edge, center[1], down[0], up[0],
+                      face_left_edge, fx[0], fy_down[0], fy_up[0]),
+        center[0], result[0]);
+    for (size_t k = 1; k < last_k; ++k) {
+      result[k] = combine(
+          StencilUpdate(center[k], center[k - 1], center[k + 1], down[k],
+                        up[k], fx[k - 1], fx[k], fy_down[k], fy_up[k]),
+          center[k], result[k]);
+    }
+    result[last_k] = combine(
+        StencilUpdate(center[last_k], center[last_k - 1], right_edge,
+                      down[last_k], up[last_k], fx[last_k - 1], fx[last_k],
+                      fy_down[last_k], fy_up[last_k]),
+        center[last_k], result[last_k]);
+  };
+
+  for (size_t j = row_begin; j < row_end; ++j) {
+    // Nodes of the wide stencil runs are computed once, by the fourth
+    // order, the second order takes the gaps between the runs
+    size_t col = col_begin;
+    for (size_t r = m_fourth_row_runs[j]; r < m_fourth_row_runs[j + 1]; ++r) {
+      const StencilRun &run = m_fourth_runs[r];
+      size_t begin = std::max(run.col_begin, col_begin);
+      size_t end = std::min(run.col_end, col_end);
+      if (begin >= end) {
+        continue;
+      }
+      if (col < begin) {
+        second_order(j, col, begin);
+      }
+      ComputeFourthOrderRun(run, begin, end);
+      col = end;
+    }
+    if (col < col_end) {
+      second_order(j, col, col_end);
+    }
+  }
 }
 
-bool Model::PointInHole(Point point) const {
-  /*
-   * Mathematical part - vector and pseudoscalar product.
-   * Implementation - products are considered (1,2,3 - triangle vertices, 0 -
-   * point):
-   * (x1-x0)*(y2-y1)-(x2-x1)*(y1-y0)
-   * (x2-x0)*(y3-y2)-(x3-x2)*(y2-y0)
-   * (x3-x0)*(y1-y3)-(x1-x3)*(y3-y0)
-   * If they are of the same sign, then the point is inside
-   * the triangle, otherwise the point is outside the triangle.
-   */
-  auto [check_val1, check_val2, check_val3] = CalcCheckValues(point);
+void Model::ComputePlateTile(const mtrx::Tile &tile) {
+  ComputePlateTile(tile, [](ModelNodeType updated, ModelNodeType,
+                            ModelNodeType) { return updated; });
+}
 
-  // The comparison described above takes place in the function IsInHole
-  return IsInHole({check_val1, check_val2, check_val3});
+void Model::ComputeStageTile(const mtrx::Tile &tile) {
+  // Stage keeps Y_{j-2} in the present layer until it is overwritten
+  double mu = m_stage.mu;
+  double nu = m_stage.nu;
+  double weight = m_stage.weight;
+  ComputePlateTile(tile, [=](ModelNodeType updated, ModelNodeType center,
+                             ModelNodeType previous) {
+    return mu * center + nu * previous + weight * (updated - center);
+  });
 }
 
-bool Model::PointOnBorder(Point point) const {
+/*
+ * Sampled diffusivity and node kinds of the rows around the prepared
+ * one: row r lives in the slot r % Rows, so the stencil is prepared
+ * without mesh sized temporaries. Kind is 0 for the regular node, 1 for
+ * the hole border and 2 for the hole.
+ */
+class Model::StencilWindow {
+ public:
+  // Wide stencil reaches two rows down and up
+  constexpr static size_t Rows = 5;
+
+  explicit StencilWindow(size_t cols)
+      : m_cols(cols), m_diffusivity(Rows * cols), m_kind(Rows * cols) {}
+
+  [[nodiscard]] double *Diffusivity(size_t row) {
+    return m_diffusivity.data() + (row % Rows) * m_cols;
+  }
+  [[nodiscard]] const double *Diffusivity(size_t row) const {
+    return m_diffusivity.data() + (row % Rows) * m_cols;
+  }
+  [[nodiscard]] uint8_t *Kind(size_t row) {
+    return m_kind.data() + (row % Rows) * m_cols;
+  }
+  [[nodiscard]] const uint8_t *Kind(size_t row) const {
+    return m_kind.data() + (row % Rows) * m_cols;
+  }
+
+ private:
+  size_t m_cols;
+  std::vector<double> m_diffusivity;
+  std::vector<uint8_t> m_kind;
+};
+
+void Model::PrepareStencil() {
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
+  double x_weight = m_time_delta / (m_x_delta * m_x_delta);
+  double y_weight = m_time_delta / (m_y_delta * m_y_delta);
+
+  // Fourth order operator has bigger spectral radius (16/3 against 4)
+  double stability_limit =
+      m_spatial_order == SpatialOrder::Fourth ? 0.375 : 0.5;
+
+  auto sample = [&](size_t row, double *diffusivity) {
+    for (size_t i = 0; i < cols; ++i) {
+      diffusivity[i] =
+          m_diffusivity(Point(static_cast<double>(i) * m_x_delta,
+                              static_cast<double>(row) * m_y_delta));
+    }
+  };
+
+  // The first pass checks the field and finds out, if the plate is
+  // homogeneous, then the field is never sampled again
+  std::vector<double> row_diffusivity(cols);
+  double uniform_diffusivity = m_diffusivity(Point(0.0, 0.0));
+  bool uniform = true;
+  for (size_t j = 0; j < rows; ++j) {
+    sample(j, row_diffusivity.data());
+    for (double a : row_diffusivity) {
+      if (a < 0.0 || a * (x_weight + y_weight) > stability_limit) {
+        throw exceptions::WrongDiffusivity();
+      }
+      uniform = uniform && a == uniform_diffusivity;
+    }
+  }
+
+  // Face arrays are allocated only for the varying diffusivity
+  m_uniform_stencil = uniform;
+  if (m_uniform_stencil) {
+    m_face_x->SetSize(0, 0);
+    m_face_y->SetSize(0, 0);
+    m_uniform_face_x.assign(cols, uniform_diffusivity * x_weight);
+    m_uniform_face_y.assign(cols, uniform_diffusivity * y_weight);
+  } else {
+    m_uniform_face_x.clear();
+    m_uniform_face_y.clear();
+    if (m_face_x->SizeRows() != rows || m_face_x->SizeCols() != cols) {
+      m_face_x->SetSize(rows, cols);
+      m_face_y->SetSize(rows, cols);
+    }
+  }
+
+  geometry::CrossSection section(m_hole_geometry, m_x_delta, m_y_delta);
+  section.Classify(rows, cols, m_hole_runs, m_border_nodes);
+
   /*
-   * If one of bellow values is zero, then the point
-   * lies on the side
+   * The second pass prepares the row j, when the rows j - 2 .. j + 2 are
+   * in the window. Classify lists the nodes row by row, so the kinds of
+   * the entering row are the next entries of the lists.
    */
+  StencilWindow window(cols);
+  size_t next_hole = 0;
+  size_t next_border = 0;
+  auto enter = [&](size_t row) {
+    double *diffusivity = window.Diffusivity(row);
+    if (uniform) {
+      std::fill(diffusivity, diffusivity + cols, uniform_diffusivity);
+    } else {
+      sample(row, diffusivity);
+    }
+    uint8_t *kind = window.Kind(row);
+    std::fill(kind, kind + cols, 0);
+    for (; next_border < m_border_nodes.size() &&
+           m_border_nodes[next_border].node.row == row;
+         ++next_border) {
+      kind[m_border_nodes[next_border].node.col] = 1;
+    }
+    for (; next_hole < m_hole_runs.size() &&
+           m_hole_runs[next_hole].row == row;
+         ++next_hole) {
+      std::fill(kind + m_hole_runs[next_hole].col_begin,
+                kind + m_hole_runs[next_hole].col_end, 2);
+    }
+  };
+
+  m_fourth_runs.clear();
+  m_fourth_row_runs.assign(rows + 1, 0);
+  m_plate_runs.clear();
+  m_plate_row_runs.assign(rows + 1, 0);
+  m_border_diffusivity.clear();
+  size_t border = 0;
+  for (size_t j = 0; j < std::min<size_t>(rows, 2); ++j) {
+    enter(j);
+  }
+  for (size_t j = 0; j < rows; ++j) {
+    if (j + 2 < rows) {
+      enter(j + 2);
+    }
+    const double *diffusivity = window.Diffusivity(j);
+    for (size_t i = 0; i < cols && !m_uniform_stencil; ++i) {
+      m_face_x->At(j, i) =
+          i + 1 < cols
+              ? FaceDiffusivity(diffusivity[i], diffusivity[i + 1]) * x_weight
+              : 0.0;
+      m_face_y->At(j, i) =
+          j + 1 < rows ? FaceDiffusivity(diffusivity[i],
+                                         window.Diffusivity(j + 1)[i]) *
+                             y_weight
+                       : 0.0;
+    }
+
+    m_fourth_row_runs[j] = m_fourth_runs.size();
+    if (m_spatial_order == SpatialOrder::Fourth) {
+      PrepareFourthOrderRuns(window, j, x_weight, y_weight);
+    }
+    m_plate_row_runs[j] = m_plate_runs.size();
+    PreparePlateRuns(window, j);
+
+    // Inner neighbor of the border node is in the nearest rows
+    for (; border < m_border_nodes.size() &&
+           m_border_nodes[border].node.row == j;
+         ++border) {
+      const BorderNode &node = m_border_nodes[border];
+      m_border_diffusivity.push_back(
+          node.has_inner
+              ? FaceDiffusivity(diffusivity[node.node.col],
+                                window.Diffusivity(node.inner.row)
+                                    [node.inner.col])
+              : 0.0);
+    }
+  }
+  m_fourth_row_runs[rows] = m_fourth_runs.size();
+  m_plate_row_runs[rows] = m_plate_runs.size();
+  m_plate_nodes = rows * cols;
+  for (const NodeRun &run : m_hole_runs) {
+    m_plate_nodes -= run.col_end - run.col_begin;
+  }
+  m_stencil_ready = true;
+}
+
+void Model::PreparePlateRuns(const StencilWindow &window, size_t row) {
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
+
+  // Inner nodes, that are neither hole nor its border
+  const uint8_t *kind = window.Kind(row);
+  for (size_t i = 1; row > 0 && row + 1 < rows && i + 1 < cols; ++i) {
+    if (kind[i] != 0) {
+      continue;
+    }
+    if (m_plate_row_runs[row] < m_plate_runs.size() &&
+        m_plate_runs.back().col_end == i) {
+      ++m_plate_runs.back().col_end;
+    } else {
+      m_plate_runs.push_back({i, i + 1});
+    }
+  }
+}
+
+void Model::PrepareActiveTiles() {
+  size_t side = ContiguousSide<MatrixBuilder::TargetType<ModelNodeType>>(
+      m_active_tile_size);
 
-  //   Check neighbor points
-  if (!PointInHole(point)) {
-    if (PointInHole(Point(point.x, point.y - m_y_delta))) {
-      return true;
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
+  m_active_tiles_x = (cols + side - 1) / side;
+  m_active_tiles_y = (rows + side - 1) / side;
+  m_active_tiles.clear();
+  for (size_t ty = 0; ty < m_active_tiles_y; ++ty) {
+    for (size_t tx = 0; tx < m_active_tiles_x; ++tx) {
+      m_active_tiles.push_back({ty * side, std::min((ty + 1) * side, rows),
+                                tx * side, std::min((tx + 1) * side, cols)});
+    }
+  }
+  m_tile_changed.assign(m_active_tiles.size(), 1);
+  m_tile_synced.assign(m_active_tiles.size(), 0);
+  m_tile_change.assign(m_active_tiles.size(), 0.0);
+  m_tile_partials.assign(m_active_tiles.size(), ReductionPartial());
+}
+
+void Model::ComputeActiveTiles() {
+  // Tile is active, if it or one of its neighbors has changed
+  m_active_list.clear();
+  for (size_t ty = 0; ty < m_active_tiles_y; ++ty) {
+    for (size_t tx = 0; tx < m_active_tiles_x; ++tx) {
+      bool active = false;
+      for (size_t ny = ty == 0 ? 0 : ty - 1;
+           ny <= std::min(ty + 1, m_active_tiles_y - 1) && !active; ++ny) {
+        for (size_t nx = tx == 0 ? 0 : tx - 1;
+             nx <= std::min(tx + 1, m_active_tiles_x - 1); ++nx) {
+          if (m_tile_changed[ny * m_active_tiles_x + nx] != 0) {
+            active = true;
+            break;
+          }
+        }
+      }
+      if (active) {
+        m_active_list.push_back(ty * m_active_tiles_x + tx);
+      }
     }
-    if (PointInHole(Point(point.x, point.y + m_y_delta))) {
-      return true;
+  }
+
+  // Partials of the skipped tiles don't change, they are kept per tile
+  mtrx::alloc::ParallelRows(
+      m_active_list.size(), m_workers, [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; ++n) {
+          size_t index = m_active_list[n];
+          ComputePlateTile(m_active_tiles[index]);
+          if (m_reduce_temperature) {
+            m_tile_partials[index] = ReductionPartial();
+            AccumulatePlate(m_active_tiles[index], m_tile_partials[index]);
+          }
+        }
+      });
+  if (m_reduce_temperature) {
+    for (const ReductionPartial &partial : m_tile_partials) {
+      m_layer_partial.Merge(partial);
     }
-    if (PointInHole(Point(point.x - m_x_delta, point.y))) {
-      return true;
+  }
+
+  /*
+   * Skipped tiles keep the last values. Both layers of the skipped tile
+   * are made equal once, after that the tile costs nothing until it
+   * becomes active again.
+   */
+  const auto &last = *m_mesh_ptr_last;
+  auto &present = *m_mesh_ptr_present;
+  size_t next_active = 0;
+  for (size_t index = 0; index < m_active_tiles.size(); ++index) {
+    if (next_active < m_active_list.size() &&
+        m_active_list[next_active] == index) {
+      ++next_active;
+      m_tile_synced[index] = 0;
+      continue;
     }
-    if (PointInHole(Point(point.x + m_x_delta, point.y))) {
-      return true;
+    m_tile_changed[index] = 0;
+    if (m_tile_synced[index] == 0) {
+      const mtrx::Tile &tile = m_active_tiles[index];
+      for (size_t j = tile.row_begin; j < tile.row_end; ++j) {
+        std::copy(&last.At(j, tile.col_begin),
+                  &last.At(j, tile.col_end - 1) + 1,
+                  &present.At(j, tile.col_begin));
+      }
+      m_tile_synced[index] = 1;
     }
+  }
+}
+
+void Model::UpdateActiveTiles() {
+  // Layer is complete here, so hole and boundaries are measured too
+  const auto &last = *m_mesh_ptr_last;
+  const auto &present = *m_mesh_ptr_present;
+  mtrx::alloc::ParallelRows(
+      m_active_list.size(), m_workers, [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; ++n) {
+          size_t index = m_active_list[n];
+          const mtrx::Tile &tile = m_active_tiles[index];
+          ModelNodeType change = 0.0;
+          for (size_t j = tile.row_begin; j < tile.row_end; ++j) {
+            for (size_t i = tile.col_begin; i < tile.col_end; ++i) {
+              change = std::max(change,
+                                std::abs(present.At(j, i) - last.At(j, i)));
+            }
+          }
+          m_tile_change[index] = change;
+        }
+      });
+  for (size_t index : m_active_list) {
+    m_tile_changed[index] = m_tile_change[index] > m_incremental_epsilon;
+  }
+
+  /*
+   * Skipped tile and all its neighbors changed less than epsilon on the
+   * previous layer. The explicit scheme is a convex combination of the
+   * neighbors, so the skipped tile would change less than epsilon too,
+   * and the maximum error grows at most by epsilon per such layer.
+   */
+  ++m_incremental_stats.layers;
+  m_incremental_stats.tiles_total += m_active_tiles.size();
+  m_incremental_stats.tiles_computed += m_active_list.size();
+  if (m_active_list.size() < m_active_tiles.size()) {
+    m_incremental_stats.error_bound += m_incremental_epsilon;
+  }
+}
+
+void Model::PrepareFourthOrderRuns(const StencilWindow &window, size_t row,
+                                   double x_weight, double y_weight) {
+  size_t rows = m_mesh_ptr_present->SizeRows();
+  size_t cols = m_mesh_ptr_present->SizeCols();
 
-    if (PointInHole(Point(point.x + m_x_delta, point.y - m_y_delta))) {
-      return true;
+  /*
+   * Wide stencil is used, if the node and its nearest neighbors are
+   * regular inner nodes, there is no hole nodes in the stencil and
+   * the material is the same in the whole stencil. Otherwise the node
+   * falls back to the second order.
+   */
+  auto fourth_order = [&](size_t i) {
+    if (row < 2 || row + 2 >= rows || i < 2 || i + 2 >= cols) {
+      return false;
     }
-    if (PointInHole(Point(point.x + m_x_delta, point.y + m_y_delta))) {
-      return true;
+    const std::array<std::pair<ptrdiff_t, ptrdiff_t>, 9> stencil{
+        {{0, 0}, {0, -1}, {0, 1}, {-1, 0}, {1, 0},
+         {0, -2}, {0, 2}, {-2, 0}, {2, 0}}};
+    double a = window.Diffusivity(row)[i];
+    for (size_t n = 0; n < stencil.size(); ++n) {
+      auto j = static_cast<size_t>(static_cast<ptrdiff_t>(row) +
+                                   stencil[n].first);
+      auto k = static_cast<size_t>(static_cast<ptrdiff_t>(i) +
+                                   stencil[n].second);
+      uint8_t max_kind = n < 5 ? 0 : 1;
+      if (window.Kind(j)[k] > max_kind || window.Diffusivity(j)[k] != a) {
+        return false;
+      }
     }
-    if (PointInHole(Point(point.x - m_x_delta, point.y - m_y_delta))) {
-      return true;
+    return true;
+  };
+
+  for (size_t i = 0; i < cols; ++i) {
+    if (!fourth_order(i)) {
+      continue;
     }
-    if (PointInHole(Point(point.x - m_x_delta, point.y + m_y_delta))) {
-      return true;
+    double a = window.Diffusivity(row)[i];
+    if (m_fourth_row_runs[row] < m_fourth_runs.size()) {
+      StencilRun &run = m_fourth_runs.back();
+      if (run.col_end == i && run.diffusivity == a) {
+        ++run.col_end;
+        continue;
+      }
     }
+    m_fourth_runs.push_back(
+        {row, i, i + 1, a, a * x_weight / 12, a * y_weight / 12});
   }
+}
 
-  // The comparison described above takes place in the function IsInHole
-  return false;
+void Model::ComputeFourthOrderRun(const StencilRun &run, size_t col_begin,
+                                  size_t col_end) {
+  const auto &last = *m_mesh_ptr_last;
+  auto &present = *m_mesh_ptr_present;
+  size_t row = run.row;
+  for (size_t i = col_begin; i < col_end; ++i) {
+    ModelNodeType center = last.At(row, i);
+    ModelNodeType dx = -last.At(row, i - 2) + 16 * last.At(row, i - 1) -
+                       30 * center + 16 * last.At(row, i + 1) -
+                       last.At(row, i + 2);
+    ModelNodeType dy = -last.At(row - 2, i) + 16 * last.At(row - 1, i) -
+                       30 * center + 16 * last.At(row + 1, i) -
+                       last.At(row + 2, i);
+    present.At(row, i) = center + run.x_weight * dx + run.y_weight * dy;
+  }
 }
 
 }  // namespace fdm
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "Model3D.hpp"
+
+#include <algorithm>
+#include <future>
+#include <utility>
+
+namespace fdm {
+Model3D::Model3D(double width, double height, double length, double delta_n,
+                 double time_delta, SlabStorePointerType store)
+    : m_nodes_x(static_cast<size_t>(width / delta_n)),
+      m_nodes_y(static_cast<size_t>(height / delta_n)),
+      m_nodes_z(static_cast<size_t>(length / delta_n)),
+      m_delta(delta_n),
+      m_time_delta(time_delta),
+      m_diffusivity(DefDiffusivity),
+      m_workers(1),
+      m_monitored_slab(m_nodes_z / 2),
+      m_store(std::move(store)) {
+  if ((m_time_delta / m_delta) * (m_time_delta / m_delta) > 0.5) {
+    throw exceptions::WrongDeltaRel();
+  }
+  if (m_nodes_z < 3) {
+    throw exceptions::WrongSlabsAmount();
+  }
+  if (!m_store) {
+    m_store = std::make_shared<slab::MemorySlabStore<ModelNodeType>>();
+  }
+  for (auto &slab : m_last_slabs) {
+    slab = MakeSlab();
+  }
+  m_result_slab = MakeSlab();
+  m_end_slab = MakeSlab();
+  m_store->Resize(m_nodes_z, m_nodes_y * m_result_slab->Stride());
+}
+
+void Model3D::SetHoleGeometry(Point p1, Point p2, Point p3) {
+  m_hole_geometry[0] = p1;
+  m_hole_geometry[1] = p2;
+  m_hole_geometry[2] = p3;
+  m_section_ready = false;
+}
+
+void Model3D::SetDiffusivity(double diffusivity) {
+  m_diffusivity = diffusivity;
+}
+
+void Model3D::SetWorkers(size_t workers) {
+  m_workers = std::max<size_t>(workers, 1);
+  for (auto &slab : m_last_slabs) {
+    slab->SetWorkers(m_workers);
+  }
+  m_result_slab->SetWorkers(m_workers);
+  m_end_slab->SetWorkers(m_workers);
+}
+
+void Model3D::SetInitialCondition(ModelNodeType init_conditions) {
+  m_result_slab->FillMatrix(init_conditions);
+  for (size_t z = 0; z < m_nodes_z; ++z) {
+    WriteSlab(z, *m_result_slab);
+  }
+  m_store->Sync();
+}
+
+void Model3D::SetOuterRestrictions(
+    const restr::BoundaryRestrictionsStorageType<ModelNodeType>
+        &restrictions) {
+  m_outer_restrictions = restrictions;
+}
+
+void Model3D::SetInnerRestrictions(
+    const restr::BoundaryRestrincionPointerType<ModelNodeType> &restriction) {
+  m_inner_restriction = restriction;
+}
+
+void Model3D::SetEndRestrictions(
+    const restr::EndRestrictionsStorageType<ModelNodeType> &restrictions) {
+  m_end_restrictions = restrictions;
+}
+
+void Model3D::TimeIntegrate(
+    double total_time, solution::SolutionStorageBase<ModelNodeType> &storage,
+    ModelNodeType tube_flow) {
+  double weight = m_diffusivity * m_time_delta / (m_delta * m_delta);
+  if (m_diffusivity < 0.0 || 3 * weight > 0.5) {
+    throw exceptions::WrongDiffusivity();
+  }
+  if (!m_section_ready) {
+    PrepareSection();
+  }
+  SaveResult(storage, m_monitored_slab);
+
+  auto time_integrate_iterations =
+      static_cast<size_t>(total_time / m_time_delta);
+  for (size_t t = 0; t < time_integrate_iterations; ++t) {
+    Step(storage, tube_flow);
+  }
+  SaveResult(storage, m_monitored_slab);
+}
+
+void Model3D::SetMonitoredSlab(size_t slab) {
+  if (slab >= m_nodes_z) {
+    throw exceptions::WrongSlabIndex();
+  }
+  m_monitored_slab = slab;
+}
+
+void Model3D::SaveResult(
+    solution::SolutionStorageBase<ModelNodeType> &storage, size_t slab) {
+  if (slab >= m_nodes_z) {
+    throw exceptions::WrongSlabIndex();
+  }
+  ReadSlab(slab, *m_result_slab);
+  storage.CommitLayer(m_result_slab);
+}
+
+Model3D::SlabPointerType Model3D::MakeSlab() const {
+  auto slab = std::make_shared<SlabType>();
+  slab->SetWorkers(m_workers);
+  slab->SetSize(m_nodes_y, m_nodes_x);
+  return slab;
+}
+
+void Model3D::ReadSlab(size_t z, SlabType &slab) {
+  m_store->Read(z, slab.RowData(0));
+}
+
+void Model3D::WriteSlab(size_t z, const SlabType &slab) {
+  m_store->Write(z, slab.RowData(0));
+}
+
+void Model3D::PrepareSection() {
+  geometry::CrossSection section(m_hole_geometry, m_delta, m_delta);
+  section.Classify(m_nodes_y, m_nodes_x, m_hole_nodes, m_border_nodes);
+  m_section_ready = true;
+}
+
+void Model3D::Step(solution::SolutionStorageBase<ModelNodeType> &storage,
+                   ModelNodeType tube_flow) {
+  // Old slab z is kept in m_last_slabs[z % LastLayerSlabs]
+  auto last = [this](size_t z) -> SlabType & {
+    return *m_last_slabs[z % LastLayerSlabs];
+  };
+  ReadSlab(0, last(0));
+  ReadSlab(1, last(1));
+  std::future<void> read_ahead;
+  auto start_read = [&](size_t z) {
+    if (m_store->ReadAhead()) {
+      read_ahead = std::async(std::launch::async,
+                              [this, z, &slab = last(z)]() {
+                                ReadSlab(z, slab);
+                              });
+    } else {
+      ReadSlab(z, last(z));
+    }
+  };
+  start_read(2);
+
+  for (size_t z = 1; z + 1 < m_nodes_z; ++z) {
+    if (read_ahead.valid()) {
+      read_ahead.get();
+    }
+    if (z + 2 < m_nodes_z) {
+      start_read(z + 2);
+    }
+
+    ComputeSlab(last(z - 1), last(z), last(z + 1), *m_result_slab,
+                tube_flow);
+
+    // Ends depend on the new values of the nearest slabs. Old values
+    // of the slab 0 are not necessary any more.
+    if (z == 1) {
+      ComputeEndSlab(m_end_restrictions[restr::FRONT_RESTRICTION],
+                     *m_result_slab, *m_end_slab);
+      WriteSlab(0, *m_end_slab);
+      if (m_monitored_slab == 0) {
+        storage.CommitLayer(m_end_slab);
+      }
+    }
+    if (z + 2 == m_nodes_z) {
+      ComputeEndSlab(m_end_restrictions[restr::BACK_RESTRICTION],
+                     *m_result_slab, *m_end_slab);
+      WriteSlab(z + 1, *m_end_slab);
+      if (m_monitored_slab == z + 1) {
+        storage.CommitLayer(m_end_slab);
+      }
+    }
+
+    WriteSlab(z, *m_result_slab);
+    if (m_monitored_slab == z) {
+      storage.CommitLayer(m_result_slab);
+    }
+  }
+  m_store->Sync();
+}
+
+void Model3D::ComputeSlab(const SlabType &back, const SlabType &center,
+                          const SlabType &front, SlabType &result,
+                          ModelNodeType tube_flow) {
+  double weight = m_diffusivity * m_time_delta / (m_delta * m_delta);
+  size_t rows = m_nodes_y;
+  size_t cols = m_nodes_x;
+
+  mtrx::alloc::ParallelRows(rows, m_workers, [&](size_t begin, size_t end) {
+    for (size_t j = std::max<size_t>(begin, 1); j < std::min(end, rows - 1);
+         ++j) {
+      const ModelNodeType *c = center.RowData(j);
+      const ModelNodeType *down = center.RowData(j - 1);
+      const ModelNodeType *up = center.RowData(j + 1);
+      const ModelNodeType *b = back.RowData(j);
+      const ModelNodeType *f = front.RowData(j);
+      ModelNodeType *r = result.RowData(j);
+      for (size_t i = 1; i + 1 < cols; ++i) {
+        r[i] = c[i] + weight * (c[i - 1] + c[i + 1] + down[i] + up[i] +
+                                b[i] + f[i] - 6 * c[i]);
+      }
+    }
+  });
+
+  // Same hole handling as in the plate model
+  for (const NodeIndex &node : m_hole_nodes) {
+    result.At(node.row, node.col) = tube_flow;
+  }
+  for (const BorderNode &border : m_border_nodes) {
+    ModelNodeType inner_value =
+        border.has_inner ? center.At(border.inner.row, border.inner.col)
+                         : 0.0;
+    result.At(border.node.row, border.node.col) =
+        m_inner_restriction->operator()(inner_value, m_delta);
+  }
+
+  ComputeSectionBoundaries(result);
+}
+
+void Model3D::ComputeSectionBoundaries(SlabType &slab) {
+  // Same order and inner neighbors as Model::ComputeBoundaries
+  size_t rows = m_nodes_y;
+  size_t cols = m_nodes_x;
+  for (size_t j = 1; j + 1 < rows; ++j) {
+    slab.At(j, 0) = m_outer_restrictions[restr::LEFT_RESTRICTION]->operator()(
+        slab.At(j, 1), m_delta);
+    slab.At(j, cols - 1) =
+        m_outer_restrictions[restr::RIGHT_RESTRICTION]->operator()(
+            slab.At(j, cols - 2), m_delta);
+  }
+  for (size_t i = 0; i < cols; ++i) {
+    slab.At(0, i) = m_outer_restrictions[restr::DOWN_RESTRICTION]->operator()(
+        slab.At(1, i), m_delta);
+    slab.At(rows - 1, i) =
+        m_outer_restrictions[restr::UP_RESTRICTION]->operator()(
+            slab.At(rows - 2, i), m_delta);
+  }
+}
+
+void Model3D::ComputeEndSlab(
+    const restr::BoundaryRestrincionPointerType<ModelNodeType> &restriction,
+    const SlabType &inner, SlabType &result) {
+  for (size_t j = 0; j < m_nodes_y; ++j) {
+    const ModelNodeType *from = inner.RowData(j);
+    ModelNodeType *to = result.RowData(j);
+    for (size_t i = 0; i < m_nodes_x; ++i) {
+      to[i] = restriction->operator()(from[i], m_delta);
+    }
+  }
+}
+}  // namespace fdm
@@ -0,0 +1,97 @@
+#include "TuningCache.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace fdm {
+namespace tune {
+namespace {
+// Distinguishes the processes, that write the same cache
+unsigned long ProcessToken() {
+#if defined(__linux__)
+  return static_cast<unsigned long>(getpid());
+#else
+  static const unsigned long token = std::random_device()();
+  return token;
+#endif
+}
+}  // anonymous namespace
+
+std::string CpuModel() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.rfind("model name", 0) != 0) {
+      continue;
+    }
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      break;
+    }
+    size_t begin = line.find_first_not_of(" \t", colon + 1);
+    return begin == std::string::npos ? "unknown" : line.substr(begin);
+  }
+  return "unknown";
+}
+
+TuningCache::TuningCache(const StringType &file_name)
+    : m_file_name(file_name) {
+  Load();
+}
+
+std::optional<TuningCache::StringType> TuningCache::Find(
+    const StringType &key) const {
+  auto entry = m_entries.find(key);
+  if (entry == m_entries.end()) {
+    return std::nullopt;
+  }
+  return entry->second;
+}
+
+void TuningCache::Store(const StringType &key, const StringType &value) {
+  m_entries[key] = value;
+  Save();
+}
+
+void TuningCache::Load() {
+  std::ifstream file(m_file_name);
+  StringType line;
+  while (std::getline(file, line)) {
+    size_t tab = line.rfind('\t');
+    if (tab == StringType::npos) {
+      continue;
+    }
+    m_entries[line.substr(0, tab)] = line.substr(tab + 1);
+  }
+}
+
+void TuningCache::Save() const {
+  // Other processes could share the cache, so the file is replaced at
+  // once instead of being rewritten in place. Every writer has its own
+  // temporary file, otherwise concurrent writers would mix their entries.
+  static std::atomic<size_t> saves = 0;
+  StringType temporary = m_file_name + ".tmp." +
+                         std::to_string(ProcessToken()) + '.' +
+                         std::to_string(saves++);
+  std::ofstream file(temporary, std::ios::trunc);
+  if (!file) {
+    return;
+  }
+  for (const auto &[key, value] : m_entries) {
+    file << key << '\t' << value << '\n';
+  }
+  // Buffered data is written on close, so only then errors are known
+  file.close();
+  if (!file || std::rename(temporary.c_str(), m_file_name.c_str()) != 0) {
+    std::remove(temporary.c_str());
+  }
+}
+}  // namespace tune
+}  // namespace fdm